@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Compares the analytic shadow against the box blur cascade, which is what
+// the decoration uses by default. The deviation of every case is printed and
+// recorded as a test property.
+
+// own
+#include "BoxShadowHelper.h"
+
+// Qt
+#include <QColor>
+#include <QImage>
+
+// GTest
+#include <gtest/gtest.h>
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+using Material::BoxShadowRenderer;
+
+struct ShadowCase {
+    int radius;
+    qreal borderRadius;
+    qreal scale;
+};
+
+// Largest per-pixel alpha difference allowed between the two algorithms.
+// The cases below measure at most 7/255 (radius 8), one more is left for
+// rounding differences between Qt versions.
+constexpr int s_maxDeviation = 8;
+// Average over the whole texture, measured at most 1.93/255 (radius 8).
+constexpr double s_maxMeanDeviation = 2.0;
+
+QImage renderShadow(const ShadowCase &shadowCase, BoxShadowRenderer::Algorithm algorithm)
+{
+    const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(shadowCase.radius);
+
+    BoxShadowRenderer renderer;
+    renderer.setAlgorithm(algorithm);
+    renderer.setBoxSize(boxSize * shadowCase.scale);
+    renderer.setBorderRadius(shadowCase.borderRadius * shadowCase.scale);
+    renderer.addShadow(QPointF(0, 0), shadowCase.radius * shadowCase.scale, Qt::black);
+    return renderer.render();
+}
+
+class BoxShadowTest : public testing::TestWithParam<ShadowCase>
+{
+};
+
+TEST_P(BoxShadowTest, AnalyticMatchesBoxBlur)
+{
+    const ShadowCase shadowCase = GetParam();
+    const QImage boxBlur = renderShadow(shadowCase, BoxShadowRenderer::Algorithm::BoxBlur);
+    const QImage analytic = renderShadow(shadowCase, BoxShadowRenderer::Algorithm::Analytic);
+
+    ASSERT_FALSE(boxBlur.isNull());
+    ASSERT_EQ(boxBlur.size(), analytic.size());
+    ASSERT_EQ(boxBlur.format(), analytic.format());
+
+    int maxDeviation = 0;
+    qint64 totalDeviation = 0;
+    for (int y = 0; y < boxBlur.height(); ++y) {
+        const QRgb *expected = reinterpret_cast<const QRgb *>(boxBlur.constScanLine(y));
+        const QRgb *actual = reinterpret_cast<const QRgb *>(analytic.constScanLine(y));
+        for (int x = 0; x < boxBlur.width(); ++x) {
+            const int deviation = std::abs(qAlpha(expected[x]) - qAlpha(actual[x]));
+            maxDeviation = std::max(maxDeviation, deviation);
+            totalDeviation += deviation;
+        }
+    }
+    const double meanDeviation = double(totalDeviation) / (boxBlur.width() * boxBlur.height());
+
+    RecordProperty("maxDeviation", maxDeviation);
+    RecordProperty("meanDeviation", std::to_string(meanDeviation));
+    std::cout << "radius " << shadowCase.radius << " corner " << shadowCase.borderRadius << " scale " << shadowCase.scale
+              << ": max " << maxDeviation << "/255, mean " << meanDeviation << "/255" << std::endl;
+
+    EXPECT_LE(maxDeviation, s_maxDeviation);
+    EXPECT_LE(meanDeviation, s_maxMeanDeviation);
+}
+
+// The blur radii of the decoration's shadow presets, with square and
+// rounded corners, at 1x and 2x.
+INSTANTIATE_TEST_SUITE_P(Presets,
+                         BoxShadowTest,
+                         testing::Values(ShadowCase{8, 0, 1},
+                                         ShadowCase{8, 6.5, 1},
+                                         ShadowCase{16, 6.5, 1},
+                                         ShadowCase{24, 6.5, 1},
+                                         ShadowCase{32, 6.5, 1},
+                                         ShadowCase{48, 6.5, 1},
+                                         ShadowCase{64, 0, 1},
+                                         ShadowCase{64, 6.5, 1},
+                                         ShadowCase{16, 6.5, 2},
+                                         ShadowCase{64, 6.5, 2}));
+
+} // anonymous namespace
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Matching a few thousand windows against hundreds of exception rules,
+// with the compiled matcher and with the rule by rule loop it replaced.
+
+// own
+#include "ExceptionMatcher.h"
+
+// Qt
+#include <QRegularExpression>
+#include <QStringList>
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using Material::ExceptionMatcher;
+using Material::ExceptionType;
+using Material::MatchingMode;
+
+constexpr int s_windowCount = 5000;
+
+struct Window {
+    QString caption;
+    QString windowClass;
+};
+
+// A mix of the four kinds of rules, in a fixed order.
+QList<ExceptionMatcher::Rule> makeRules(int count)
+{
+    QList<ExceptionMatcher::Rule> rules;
+    rules.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        ExceptionMatcher::Rule rule;
+        switch (i % 4) {
+        case 0:
+            rule.type = ExceptionType::WindowClass;
+            rule.matchingMode = MatchingMode::ExactMatch;
+            rule.pattern = QStringLiteral("app%1").arg(i);
+            break;
+        case 1:
+            rule.type = ExceptionType::WindowTitle;
+            rule.matchingMode = MatchingMode::ExactMatch;
+            rule.pattern = QStringLiteral("Document %1 - Editor").arg(i);
+            break;
+        case 2:
+            rule.type = ExceptionType::WindowClass;
+            rule.matchingMode = MatchingMode::RegularExpression;
+            rule.pattern = QStringLiteral("^org\\.example\\.tool%1$").arg(i);
+            break;
+        default:
+            rule.type = ExceptionType::WindowTitle;
+            rule.matchingMode = MatchingMode::RegularExpression;
+            rule.pattern = QStringLiteral("Project %1 .* Viewer").arg(i);
+            break;
+        }
+        rules.append(rule);
+    }
+    return rules;
+}
+
+// About half of the windows match one of the rules.
+QList<Window> makeWindows(int ruleCount)
+{
+    QList<Window> windows;
+    windows.reserve(s_windowCount);
+    for (int i = 0; i < s_windowCount; ++i) {
+        const int n = i % (ruleCount * 2);
+        windows.append(Window{
+            (i % 2) ? QStringLiteral("Document %1 - Editor").arg(n) : QStringLiteral("Project %1 - main.cc - Viewer").arg(n),
+            (i % 3) ? QStringLiteral("app%1 App%1").arg(n) : QStringLiteral("org.example.tool%1").arg(n),
+        });
+    }
+    return windows;
+}
+
+// The loop SettingsProvider used before the matcher.
+class LinearMatcher
+{
+public:
+    explicit LinearMatcher(const QList<ExceptionMatcher::Rule> &rules)
+        : m_rules(rules)
+    {
+        for (const auto &rule : rules) {
+            m_regexes.append(rule.matchingMode == MatchingMode::RegularExpression
+                                 ? QRegularExpression(rule.pattern, QRegularExpression::CaseInsensitiveOption)
+                                 : QRegularExpression());
+        }
+    }
+
+    int match(const QString &caption, const QString &windowClass) const
+    {
+        static const QRegularExpression splitRegex(QStringLiteral("[\\s\\r\\n\\t\\x00]+"));
+
+        for (int i = 0; i < m_rules.size(); ++i) {
+            const auto &rule = m_rules.at(i);
+            const QString &value = rule.type == ExceptionType::WindowTitle ? caption : windowClass;
+
+            if (rule.matchingMode == MatchingMode::ExactMatch) {
+                if (value.compare(rule.pattern, Qt::CaseInsensitive) == 0) {
+                    return i;
+                }
+                if (rule.type == ExceptionType::WindowClass) {
+                    const QStringList components = value.split(splitRegex, Qt::SkipEmptyParts);
+                    for (const QString &component : components) {
+                        if (component.compare(rule.pattern, Qt::CaseInsensitive) == 0) {
+                            return i;
+                        }
+                    }
+                }
+            } else if (m_regexes.at(i).match(value).hasMatch()) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+private:
+    QList<ExceptionMatcher::Rule> m_rules;
+    QList<QRegularExpression> m_regexes;
+};
+
+template<typename Matcher>
+void matchWindows(benchmark::State &state, const Matcher &matcher, const QList<Window> &windows)
+{
+    for (auto _ : state) {
+        int matched = 0;
+        for (const Window &window : windows) {
+            matched += matcher.match(window.caption, window.windowClass) >= 0;
+        }
+        benchmark::DoNotOptimize(matched);
+    }
+    state.SetItemsProcessed(state.iterations() * windows.size());
+}
+
+void BM_LinearMatch(benchmark::State &state)
+{
+    const LinearMatcher matcher(makeRules(state.range(0)));
+    matchWindows(state, matcher, makeWindows(state.range(0)));
+}
+
+void BM_CompiledMatch(benchmark::State &state)
+{
+    const auto rules = makeRules(state.range(0));
+    const auto windows = makeWindows(state.range(0));
+
+    ExceptionMatcher matcher;
+    matcher.compile(rules);
+
+    // Both must pick the same rule for every window.
+    const LinearMatcher reference(rules);
+    for (const Window &window : windows) {
+        if (matcher.match(window.caption, window.windowClass) != reference.match(window.caption, window.windowClass)) {
+            state.SkipWithError("the compiled matcher disagrees with the linear one");
+            return;
+        }
+    }
+
+    matchWindows(state, matcher, windows);
+}
+
+void BM_Compile(benchmark::State &state)
+{
+    const auto rules = makeRules(state.range(0));
+    for (auto _ : state) {
+        ExceptionMatcher matcher;
+        matcher.compile(rules);
+        benchmark::DoNotOptimize(matcher);
+    }
+}
+
+BENCHMARK(BM_LinearMatch)->Arg(100)->Arg(300)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompiledMatch)->Arg(100)->Arg(300)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Compile)->Arg(100)->Arg(300)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+} // anonymous namespace
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Time and heap of reading the configuration with 50 exception rules,
+// into ResolvedSettings snapshots and into one merged InternalSettings
+// per rule as it was done before. The rules come from
+// data/kdecoration_materialrc, never from the user's configuration.
+
+// own
+#include "ExceptionList.h"
+#include "InternalSettings.h"
+#include "Material.h"
+#include "ResolvedSettings.h"
+#include "SettingsProvider.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTemporaryDir>
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// std
+#include <memory>
+#include <utility>
+
+#if HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+namespace
+{
+
+using namespace Material;
+
+// Bytes in use on the heap, or -1 where the C library cannot tell.
+qint64 heapInUse()
+{
+#if HAVE_MALLINFO2
+    return qint64(mallinfo2().uordblks);
+#else
+    return -1;
+#endif
+}
+
+void setHeapCounter(benchmark::State &state, qint64 before)
+{
+    if (before >= 0) {
+        state.counters["heapBytes"] = benchmark::Counter(heapInUse() - before);
+    }
+}
+
+// What SettingsProvider kept before the snapshots.
+struct OldSettings {
+    InternalSettingsPtr defaults;
+    ExceptionList exceptions;
+    QList<InternalSettingsPtr> merged;
+};
+
+InternalSettingsPtr mergeOld(const InternalSettingsPtr &defaults, const InternalSettingsPtr &exception)
+{
+    InternalSettingsPtr merged = cloneInternalSettings(defaults);
+    const int mask = exception->mask();
+
+    if (mask & ExceptionMask::HideTitleBar) {
+        merged->setHideTitleBar(exception->hideTitleBar());
+    }
+    if (mask & ExceptionMask::HideApplicationMenu) {
+        merged->setHideApplicationMenu(exception->hideApplicationMenu());
+        if (exception->hideApplicationMenu()) {
+            merged->setMenuAlwaysShow(false);
+        }
+    }
+    if (mask & ExceptionMask::HamburgerMenu) {
+        merged->setHamburgerMenu(exception->hamburgerMenu());
+    }
+    if (mask & ExceptionMask::HideShadow) {
+        merged->setHideShadow(exception->hideShadow());
+        if (exception->hideShadow()) {
+            merged->setShadowSize(InternalSettings::ShadowNone);
+        }
+    }
+    if (mask & ExceptionMask::SquareCorners) {
+        merged->setSquareCorners(exception->squareCorners());
+        if (exception->squareCorners()) {
+            merged->setCornerRadius(0);
+        }
+    }
+    if (mask & ExceptionMask::OutlineActive) {
+        merged->setOutlineActive(exception->outlineActive());
+    }
+
+    return merged;
+}
+
+std::unique_ptr<OldSettings> reconfigureOld()
+{
+    auto result = std::make_unique<OldSettings>();
+    result->defaults.reset(new InternalSettings());
+    result->defaults->load();
+
+    auto config = KSharedConfig::openConfig(s_configFilename);
+    config->reparseConfiguration();
+    result->exceptions.readConfig(config);
+    for (const auto &exception : result->exceptions.exceptions()) {
+        if (exception->enabled()) {
+            result->merged.append(mergeOld(result->defaults, exception));
+        }
+    }
+    return result;
+}
+
+// What SettingsProvider keeps now, besides its one InternalSettings.
+struct NewSettings {
+    ResolvedSettingsPtr defaults;
+    QList<ResolvedSettingsPtr> merged;
+    QList<ResolvedSettingsPtr> snapshots;
+};
+
+ResolvedSettingsPtr intern(const ResolvedSettings &settings, QList<ResolvedSettingsPtr> &snapshots)
+{
+    for (const ResolvedSettingsPtr &snapshot : std::as_const(snapshots)) {
+        if (*snapshot == settings) {
+            return snapshot;
+        }
+    }
+    snapshots.append(std::make_shared<const ResolvedSettings>(settings));
+    return snapshots.constLast();
+}
+
+std::unique_ptr<NewSettings> reconfigureNew(InternalSettings &config)
+{
+    auto result = std::make_unique<NewSettings>();
+    config.load();
+    const ResolvedSettings defaults = ResolvedSettings::fromInternalSettings(config);
+    result->defaults = intern(defaults, result->snapshots);
+
+    for (const ExceptionEntry &exception : readExceptionEntries(config.sharedConfig())) {
+        if (exception.enabled) {
+            result->merged.append(intern(SettingsProvider::createMergedSettings(defaults, exception), result->snapshots));
+        }
+    }
+    return result;
+}
+
+void BM_ReconfigureInternalSettings(benchmark::State &state)
+{
+    // Whatever reconfigure leaves allocated until the next one.
+    const qint64 before = heapInUse();
+    const auto held = reconfigureOld();
+    setHeapCounter(state, before);
+    state.counters["rules"] = benchmark::Counter(held->merged.size());
+    state.counters["objects"] = benchmark::Counter(1 + held->exceptions.exceptions().size() + held->merged.size());
+
+    for (auto _ : state) {
+        auto settings = reconfigureOld();
+        benchmark::DoNotOptimize(settings);
+    }
+}
+
+void BM_ReconfigureResolvedSettings(benchmark::State &state)
+{
+    const qint64 before = heapInUse();
+    auto config = std::make_unique<InternalSettings>();
+    const auto held = reconfigureNew(*config);
+    setHeapCounter(state, before);
+    state.counters["rules"] = benchmark::Counter(held->merged.size());
+    state.counters["objects"] = benchmark::Counter(1 + held->snapshots.size());
+
+    for (auto _ : state) {
+        auto settings = reconfigureNew(*config);
+        benchmark::DoNotOptimize(settings);
+    }
+}
+
+BENCHMARK(BM_ReconfigureInternalSettings)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ReconfigureResolvedSettings)->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    // KConfig looks in XDG_CONFIG_HOME first, point it at a copy of the
+    // fixture before anything opens the file.
+    QTemporaryDir configHome;
+    if (!configHome.isValid()
+        || !QFile::copy(QStringLiteral(SETTINGS_FIXTURE), configHome.filePath(s_configFilename))) {
+        qWarning() << "Cannot set up the configuration fixture" << SETTINGS_FIXTURE;
+        return 1;
+    }
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(configHome.path()));
+    qputenv("XDG_CONFIG_DIRS", QFile::encodeName(configHome.path()));
+
+    QCoreApplication app(argc, argv);
+
+    // Opened once for both, so neither heap figure includes the parsed
+    // file that KSharedConfig keeps around.
+    const KSharedConfig::Ptr config = KSharedConfig::openConfig(s_configFilename);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
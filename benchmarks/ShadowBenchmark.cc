@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Time and texture size of every shadow preset, generated the way the
+// decoration does it, with both algorithms.
+
+// own
+#include "BoxShadowHelper.h"
+
+// Qt
+#include <QColor>
+#include <QImage>
+#include <QPoint>
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+
+// std
+#include <iterator>
+
+namespace
+{
+
+using Material::BoxShadowRenderer;
+
+struct Preset {
+    const char *name;
+    int radius1;
+    QPoint offset1;
+    qreal opacity1;
+    int radius2;
+    QPoint offset2;
+    qreal opacity2;
+};
+
+// Same values as s_shadowParams in Decoration.cc.
+const Preset s_presets[] = {
+    {"Small", 16, QPoint(0, 0), 1.0, 8, QPoint(0, -2), 0.4},
+    {"Medium", 32, QPoint(0, 0), 0.9, 16, QPoint(0, -4), 0.3},
+    {"Large", 48, QPoint(0, 0), 0.8, 24, QPoint(0, -6), 0.2},
+    {"VeryLarge", 64, QPoint(0, 0), 0.7, 32, QPoint(0, -8), 0.1},
+};
+
+constexpr qreal s_borderRadius = 6.5; // default corner radius + 0.5
+
+QColor withOpacity(qreal opacity)
+{
+    QColor color(33, 33, 33);
+    color.setAlphaF(opacity);
+    return color;
+}
+
+void generateShadow(benchmark::State &state, BoxShadowRenderer::Algorithm algorithm)
+{
+    const Preset &preset = s_presets[state.range(0)];
+    state.SetLabel(preset.name);
+
+    const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(preset.radius1)
+                              .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(preset.radius2));
+
+    qint64 bytes = 0;
+    for (auto _ : state) {
+        BoxShadowRenderer renderer;
+        renderer.setAlgorithm(algorithm);
+        renderer.setBorderRadius(s_borderRadius);
+        renderer.setBoxSize(boxSize);
+        renderer.addShadow(preset.offset1, preset.radius1, withOpacity(preset.opacity1));
+        renderer.addShadow(preset.offset2, preset.radius2, withOpacity(preset.opacity2));
+
+        const QImage texture = renderer.render();
+        benchmark::DoNotOptimize(texture.constBits());
+        bytes = texture.sizeInBytes();
+    }
+
+    state.counters["textureBytes"] = benchmark::Counter(bytes);
+}
+
+void BM_BoxBlurShadow(benchmark::State &state)
+{
+    generateShadow(state, BoxShadowRenderer::Algorithm::BoxBlur);
+}
+
+void BM_AnalyticShadow(benchmark::State &state)
+{
+    generateShadow(state, BoxShadowRenderer::Algorithm::Analytic);
+}
+
+BENCHMARK(BM_BoxBlurShadow)->DenseRange(0, int(std::size(s_presets)) - 1)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AnalyticShadow)->DenseRange(0, int(std::size(s_presets)) - 1)->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
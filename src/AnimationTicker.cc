@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "AnimationTicker.h"
+
+// KDecoration
+#include <KDecoration3/Decoration>
+
+// std
+#include <utility>
+
+namespace Material
+{
+
+Transition::Transition(Setter setter)
+    : m_setter(std::move(setter))
+{
+}
+
+Transition::~Transition()
+{
+    if (m_running) {
+        AnimationTicker::self()->stop(this);
+    }
+}
+
+void Transition::start(bool forward)
+{
+    m_forward = forward;
+    if ((forward && m_progress >= 1.0) || (!forward && m_progress <= 0.0)) {
+        stop();
+        return;
+    }
+    if (!m_running) {
+        m_running = true;
+        AnimationTicker::self()->start(this);
+    }
+}
+
+void Transition::stop()
+{
+    if (m_running) {
+        m_running = false;
+        AnimationTicker::self()->stop(this);
+    }
+}
+
+void Transition::setProgress(qreal progress)
+{
+    stop();
+    m_progress = qBound(0.0, progress, 1.0);
+}
+
+bool Transition::advance(qint64 elapsed)
+{
+    const qreal step = m_duration > 0 ? qreal(elapsed) / m_duration : 1.0;
+    m_progress = qBound(0.0, m_progress + (m_forward ? step : -step), 1.0);
+
+    const bool finished = m_forward ? m_progress >= 1.0 : m_progress <= 0.0;
+    if (finished) {
+        m_running = false;
+    }
+    m_setter(m_easingCurve.valueForProgress(m_progress));
+    return !finished;
+}
+
+AnimationTicker *AnimationTicker::self()
+{
+    static AnimationTicker s_self;
+    return &s_self;
+}
+
+AnimationTicker::AnimationTicker()
+{
+    // About one frame at 60 Hz; KWin composites the result at its own pace.
+    m_timer.setInterval(16);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &AnimationTicker::tick);
+}
+
+void AnimationTicker::start(Transition *transition)
+{
+    if (!m_running.contains(transition)) {
+        m_running.append(transition);
+    }
+    if (!m_timer.isActive()) {
+        m_clock.start();
+        m_lastTick = 0;
+        m_timer.start();
+    }
+}
+
+void AnimationTicker::stop(Transition *transition)
+{
+    m_running.removeOne(transition);
+    if (m_running.isEmpty()) {
+        m_timer.stop();
+    }
+}
+
+void AnimationTicker::update(KDecoration3::Decoration *decoration, const QRectF &rect)
+{
+    if (!decoration) {
+        return;
+    }
+    if (!m_ticking) {
+        decoration->update(rect);
+        return;
+    }
+
+    for (Damage &damage : m_damage) {
+        if (damage.decoration == decoration) {
+            damage.region += rect.toAlignedRect();
+            return;
+        }
+    }
+    m_damage.append(Damage{decoration, QRegion(rect.toAlignedRect())});
+}
+
+void AnimationTicker::tick()
+{
+    const qint64 now = m_clock.elapsed();
+    const qint64 elapsed = now - m_lastTick;
+    m_lastTick = now;
+
+    m_ticking = true;
+    // Setters may start or stop other transitions, so walk a copy.
+    const QList<Transition *> running = m_running;
+    for (Transition *transition : running) {
+        if (m_running.contains(transition) && !transition->advance(elapsed)) {
+            m_running.removeOne(transition);
+        }
+    }
+    m_ticking = false;
+
+    const QList<Damage> damage = std::exchange(m_damage, {});
+    for (const Damage &entry : damage) {
+        if (!entry.decoration) {
+            continue;
+        }
+        for (const QRect &rect : entry.region) {
+            entry.decoration->update(rect);
+        }
+    }
+
+    if (m_running.isEmpty()) {
+        m_timer.stop();
+    }
+}
+
+} // namespace Material
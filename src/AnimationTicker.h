@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QEasingCurve>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QRegion>
+#include <QTimer>
+
+// std
+#include <functional>
+
+namespace KDecoration3
+{
+class Decoration;
+}
+
+namespace Material
+{
+
+/**
+ * A value that eases between 0 and 1, stepped by the AnimationTicker.
+ *
+ * Unlike QVariantAnimation, reversing a running transition continues from
+ * the current value instead of jumping to the other end.
+ **/
+class Transition
+{
+public:
+    using Setter = std::function<void(qreal)>;
+
+    explicit Transition(Setter setter);
+    ~Transition();
+
+    Transition(const Transition &) = delete;
+    Transition &operator=(const Transition &) = delete;
+
+    int duration() const { return m_duration; }
+    void setDuration(int duration) { m_duration = duration; }
+
+    void setEasingCurve(const QEasingCurve &curve) { m_easingCurve = curve; }
+
+    /**
+     * Move towards 1 if @p forward is true, towards 0 otherwise.
+     **/
+    void start(bool forward);
+    void stop();
+
+    /**
+     * Jump to @p progress without calling the setter, for a value that
+     * was set directly. Stops the transition.
+     **/
+    void setProgress(qreal progress);
+
+    bool isRunning() const { return m_running; }
+
+private:
+    /**
+     * Step by @p elapsed milliseconds. Returns false once the end is reached.
+     **/
+    bool advance(qint64 elapsed);
+
+    Setter m_setter;
+    QEasingCurve m_easingCurve = QEasingCurve::InOutCubic;
+    int m_duration = 250;
+    qreal m_progress = 0.0;
+    bool m_forward = true;
+    bool m_running = false;
+
+    friend class AnimationTicker;
+};
+
+/**
+ * Process-wide driver for all button and menu transitions.
+ *
+ * A single timer steps every running Transition once per frame, and the
+ * repaints they cause are merged per decoration and flushed at the end of
+ * the frame. The timer stops as soon as nothing is running.
+ **/
+class AnimationTicker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AnimationTicker *self();
+
+    AnimationTicker();
+
+    void start(Transition *transition);
+    void stop(Transition *transition);
+
+    /**
+     * Repaint @p rect of @p decoration. During a frame the repaint is
+     * merged with the others of the same decoration, otherwise it is
+     * passed on right away.
+     **/
+    void update(KDecoration3::Decoration *decoration, const QRectF &rect);
+
+private:
+    void tick();
+
+    struct Damage {
+        QPointer<KDecoration3::Decoration> decoration;
+        QRegion region;
+    };
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTick = 0;
+    QList<Transition *> m_running;
+    QList<Damage> m_damage;
+    bool m_ticking = false;
+};
+
+} // namespace Material
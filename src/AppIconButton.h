@@ -21,6 +21,7 @@
 // own
 #include "Button.h"
 #include "Decoration.h"
+#include "GlyphCache.h"
 
 // KDecoration
 #include <KDecoration3/DecoratedWindow>
@@ -29,8 +30,10 @@
 #include <KIconLoader>
 
 // Qt
+#include <QIcon>
 #include <QPainter>
 #include <QPalette>
+#include <QPixmap>
 
 namespace Material
 {
@@ -45,6 +48,17 @@ public:
                 button->update();
             }
         );
+        // GlyphCache drops the pixmaps of the old icon theme.
+        QObject::connect(KIconLoader::global(), &KIconLoader::iconChanged,
+            button, [button] {
+                button->update();
+            }
+        );
+        QObject::connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged,
+            button, [button] {
+                button->update();
+            }
+        );
     }
     
     static void paintIcon(Button *button, QPainter *painter, const QRectF &iconRect, const PixelSnapper &snapper) {
@@ -60,16 +74,40 @@ public:
         const auto *deco = qobject_cast<Decoration *>(button->decoration());
         auto *decoratedClient = deco->window();
 
-        const QPalette activePalette = KIconLoader::global()->customPalette();
-        QPalette palette = decoratedClient->palette();
-        palette.setColor(QPalette::WindowText, deco->titleBarForegroundColor());
-        KIconLoader::global()->setCustomPalette(palette);
-        decoratedClient->icon().paint(painter, appIconRect.toAlignedRect());
-        if (activePalette == QPalette()) {
-            KIconLoader::global()->resetPalette();
-        } else {
-            KIconLoader::global()->setCustomPalette(activePalette);
+        const QRect targetRect = appIconRect.toAlignedRect();
+        const QIcon icon = decoratedClient->icon();
+
+        IconKey key;
+        key.iconCacheKey = icon.cacheKey();
+        key.color = deco->titleBarForegroundColor().rgba();
+        key.size = targetRect.size();
+        key.devicePixelRatio = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+
+        // A new icon or color makes a new key. A new icon theme does not,
+        // GlyphCache clears the icons for it. The global palette is only
+        // swapped on a miss.
+        const QPixmap pixmap = GlyphCache::self()->icon(key, [&] {
+            const QPalette activePalette = KIconLoader::global()->customPalette();
+            QPalette palette = decoratedClient->palette();
+            palette.setColor(QPalette::WindowText, deco->titleBarForegroundColor());
+            KIconLoader::global()->setCustomPalette(palette);
+            const QPixmap rendered = icon.pixmap(key.size, key.devicePixelRatio);
+            if (activePalette == QPalette()) {
+                KIconLoader::global()->resetPalette();
+            } else {
+                KIconLoader::global()->setCustomPalette(activePalette);
+            }
+            return rendered;
+        });
+        if (pixmap.isNull()) {
+            return;
         }
+
+        // Centered like QIcon::paint() does.
+        const QSize pixmapSize = pixmap.deviceIndependentSize().toSize();
+        const QPoint topLeft(targetRect.x() + (targetRect.width() - pixmapSize.width()) / 2,
+                             targetRect.y() + (targetRect.height() - pixmapSize.height()) / 2);
+        painter->drawPixmap(topLeft, pixmap);
     }
 };
 
@@ -70,7 +70,7 @@ QColor AppMenuButton::backgroundColor() const
             return {};
         }
         
-        if (deco->m_internalSettings->useSystemColors()) {
+        if (deco->m_internalSettings->useSystemColors) {
             if (!this->isChecked() && this->isHovered()) {
                 QColor hoveredColor = KColorUtils::mix(
                     qApp->palette().color(QPalette::Highlight), 
@@ -113,7 +113,7 @@ QColor AppMenuButton::foregroundColor() const
             deco->titleBarForegroundColor(),
             0.8);
     } else {
-        if (deco->m_internalSettings->useSystemColors()) {
+        if (deco->m_internalSettings->useSystemColors) {
             if (this->isChecked()) {
                 return qApp->palette().color(QPalette::HighlightedText);
             }  
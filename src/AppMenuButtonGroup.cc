@@ -29,6 +29,7 @@
 #include "TextButton.h"
 #include "MenuOverflowButton.h"
 #include "SearchButton.h"
+#include "Tracer.h"
 
 // KDecoration
 #include <KDecoration3/DecoratedWindow>
@@ -48,7 +49,6 @@
 #include <QPainter>
 #include <QScreen>
 #include <QTimer>
-#include <QVariantAnimation>
 #include <QWidgetAction>
 
 #include <utility>
@@ -68,7 +68,7 @@ AppMenuButtonGroup::AppMenuButtonGroup(Decoration *decoration)
     , m_showing(true)
     , m_alwaysShow(true)
     , m_animationEnabled(false)
-    , m_animation(new QVariantAnimation(this))
+    , m_animation([this](qreal value) { setOpacity(value); })
     , m_opacity(1)
     , m_visibleWidth(0)
     , m_searchMenu(nullptr)
@@ -116,6 +116,7 @@ AppMenuButtonGroup::AppMenuButtonGroup(Decoration *decoration)
     setAlwaysShow(decoration->menuAlwaysShow());
     updateShowing();
     setOpacity(m_showing ? 1 : 0);
+    m_animation.setProgress(m_opacity);
 
     connect(this, &AppMenuButtonGroup::showingChanged,
             this, &AppMenuButtonGroup::onShowingChanged);
@@ -127,13 +128,8 @@ AppMenuButtonGroup::AppMenuButtonGroup(Decoration *decoration)
             this, &AppMenuButtonGroup::updateShowing);
 
     m_animationEnabled = decoration->animationsEnabled();
-    m_animation->setDuration(decoration->animationsDuration());
-    m_animation->setStartValue(0.0);
-    m_animation->setEndValue(1.0);
-    m_animation->setEasingCurve(QEasingCurve::InOutCubic);
-    connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-        setOpacity(value.toReal());
-    });
+    m_animation.setDuration(decoration->animationsDuration());
+    m_animation.setEasingCurve(QEasingCurve::InOutCubic);
 
     auto decoratedClient = decoration->window();
     connect(decoratedClient, &KDecoration3::DecoratedWindow::hasApplicationMenuChanged,
@@ -302,13 +298,13 @@ void AppMenuButtonGroup::setAnimationEnabled(bool value)
 
 int AppMenuButtonGroup::animationDuration() const
 {
-    return m_animation->duration();
+    return m_animation.duration();
 }
 
 void AppMenuButtonGroup::setAnimationDuration(int value)
 {
-    if (m_animation->duration() != value) {
-        m_animation->setDuration(value);
+    if (m_animation.duration() != value) {
+        m_animation.setDuration(value);
         Q_EMIT animationDurationChanged(value);
     }
 }
@@ -478,6 +474,8 @@ void AppMenuButtonGroup::performDebouncedMenuUpdate()
 
 void AppMenuButtonGroup::updateAppMenuModel()
 {
+    const TraceScope trace("AppMenuButtonGroup::updateAppMenuModel");
+
     m_search->invalidateCandidates();
     m_cachedWidths.clear();
 
@@ -1035,16 +1033,10 @@ void AppMenuButtonGroup::onHitRight()
 void AppMenuButtonGroup::onShowingChanged(bool showing)
 {
     if (m_animationEnabled) {
-        const QAbstractAnimation::Direction dir = showing ? QAbstractAnimation::Forward : QAbstractAnimation::Backward;
-        if (m_animation->state() == QAbstractAnimation::Running && m_animation->direction() != dir) {
-            m_animation->stop();
-        }
-        m_animation->setDirection(dir);
-        if (m_animation->state() != QAbstractAnimation::Running) {
-            m_animation->start();
-        }
+        m_animation.start(showing);
     } else {
         setOpacity(showing ? 1 : 0);
+        m_animation.setProgress(m_opacity);
     }
 }
 
@@ -19,6 +19,7 @@
 #pragma once
 
 // own
+#include "AnimationTicker.h"
 #include "AppMenuModel.h"
 #include "AppMenuButton.h"
 
@@ -33,7 +34,6 @@
 #include <QVector>
 
 class QTimer;
-class QVariantAnimation;
 
 namespace Material
 {
@@ -161,7 +161,7 @@ private:
     bool m_showing;
     bool m_alwaysShow;
     bool m_animationEnabled;
-    QVariantAnimation *m_animation;
+    Transition m_animation;
     qreal m_opacity;
     qreal m_visibleWidth;
     QPointer<QMenu> m_currentMenu;
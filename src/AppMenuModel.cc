@@ -29,6 +29,7 @@
 #include "AppMenuModel.h"
 #include "Material.h"
 #include "NavigableMenu.h"
+#include "Tracer.h"
 
 // Qt
 #include <QAction>
@@ -99,6 +100,12 @@ AppMenuModel::AppMenuModel(QObject *parent)
     m_staggerTimer->setSingleShot(true);
     m_staggerTimer->setInterval(8);
     connect(m_staggerTimer, &QTimer::timeout, this, &AppMenuModel::processNext);
+
+    if (Tracer::enabled) {
+        DBusMenuImporter::setTraceHook([](const char *name, bool begin) {
+            Tracer::self()->record(name, begin ? 'B' : 'E');
+        });
+    }
 }
 
 AppMenuModel::~AppMenuModel()
@@ -296,6 +303,8 @@ void AppMenuModel::resumeDeepCacheIfIdle(QMenu *menu)
 
 void AppMenuModel::processNext()
 {
+    const TraceScope trace("AppMenuModel::processNext");
+
     if (!m_deepCacheRequested) {
         return;
     }
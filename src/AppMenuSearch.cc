@@ -17,6 +17,7 @@
 
 #include "AppMenuSearch.h"
 #include "AppMenuModel.h"
+#include "Tracer.h"
 
 // KF
 #include <KLocalizedString>
@@ -53,6 +54,8 @@ void AppMenuSearch::setSearchMenu(QMenu *searchMenu)
 
 void AppMenuSearch::filter(const QString &text, const FilterOptions &options)
 {
+    const TraceScope trace("AppMenuSearch::filter");
+
     // Synchronous lifetime cache guard: the text cache lives 
     // only during the synchronous execution of this filter() call. 
     QPointer<AppMenuSearch> safeThis(this);
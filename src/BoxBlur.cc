@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "BoxBlur.h"
+#include "BoxBlurColumns.h"
+#include "Material.h"
+
+// Qt
+#include <QDebug>
+#include <QtGlobal>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Material
+{
+namespace
+{
+
+#if defined(__SSE2__)
+
+// 16 columns per call, as four vectors of four 32-bit sums.
+struct Sse2Lanes {
+    static constexpr int Width = 16;
+
+    struct Acc {
+        __m128i v[4];
+    };
+
+    static inline __m128i mullo(__m128i a, __m128i b)
+    {
+        // SSE2 has no 32-bit low multiply, combine the even and odd lanes.
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    static inline Acc set1(uint32_t value)
+    {
+        const __m128i v = _mm_set1_epi32(static_cast<int>(value));
+        return {{v, v, v, v}};
+    }
+
+    static inline Acc load(const uint8_t *p)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        return {{_mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                 _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)}};
+    }
+
+    static inline void store(uint8_t *p, const Acc &a)
+    {
+        // Every lane is <= 255 here, so the saturating packs are exact.
+        const __m128i lo = _mm_packs_epi32(a.v[0], a.v[1]);
+        const __m128i hi = _mm_packs_epi32(a.v[2], a.v[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packus_epi16(lo, hi));
+    }
+
+    static inline Acc add(const Acc &a, const Acc &b)
+    {
+        return {{_mm_add_epi32(a.v[0], b.v[0]), _mm_add_epi32(a.v[1], b.v[1]),
+                 _mm_add_epi32(a.v[2], b.v[2]), _mm_add_epi32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc sub(const Acc &a, const Acc &b)
+    {
+        return {{_mm_sub_epi32(a.v[0], b.v[0]), _mm_sub_epi32(a.v[1], b.v[1]),
+                 _mm_sub_epi32(a.v[2], b.v[2]), _mm_sub_epi32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc mul(const Acc &a, uint32_t factor)
+    {
+        const __m128i f = _mm_set1_epi32(static_cast<int>(factor));
+        return {{mullo(a.v[0], f), mullo(a.v[1], f), mullo(a.v[2], f), mullo(a.v[3], f)}};
+    }
+
+    static inline Acc scale(const Acc &a, uint32_t reciprocal)
+    {
+        const Acc m = mul(a, reciprocal);
+        return {{_mm_srli_epi32(m.v[0], 24), _mm_srli_epi32(m.v[1], 24),
+                 _mm_srli_epi32(m.v[2], 24), _mm_srli_epi32(m.v[3], 24)}};
+    }
+};
+
+void boxBlurColumnsSse2(const uint8_t *src, uint8_t *dst, int length, ptrdiff_t inputStride, ptrdiff_t outputStride, int lobeLeft, int lobeRight)
+{
+    boxBlurColumns<Sse2Lanes>(src, dst, length, inputStride, outputStride, lobeLeft, lobeRight);
+}
+
+#elif defined(__ARM_NEON)
+
+// 16 columns per call, as four vectors of four 32-bit sums.
+struct NeonLanes {
+    static constexpr int Width = 16;
+
+    struct Acc {
+        uint32x4_t v[4];
+    };
+
+    static inline Acc set1(uint32_t value)
+    {
+        const uint32x4_t v = vdupq_n_u32(value);
+        return {{v, v, v, v}};
+    }
+
+    static inline Acc load(const uint8_t *p)
+    {
+        const uint8x16_t bytes = vld1q_u8(p);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+        return {{vmovl_u16(vget_low_u16(lo)), vmovl_u16(vget_high_u16(lo)),
+                 vmovl_u16(vget_low_u16(hi)), vmovl_u16(vget_high_u16(hi))}};
+    }
+
+    static inline void store(uint8_t *p, const Acc &a)
+    {
+        const uint16x8_t lo = vcombine_u16(vmovn_u32(a.v[0]), vmovn_u32(a.v[1]));
+        const uint16x8_t hi = vcombine_u16(vmovn_u32(a.v[2]), vmovn_u32(a.v[3]));
+        vst1q_u8(p, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+    }
+
+    static inline Acc add(const Acc &a, const Acc &b)
+    {
+        return {{vaddq_u32(a.v[0], b.v[0]), vaddq_u32(a.v[1], b.v[1]),
+                 vaddq_u32(a.v[2], b.v[2]), vaddq_u32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc sub(const Acc &a, const Acc &b)
+    {
+        return {{vsubq_u32(a.v[0], b.v[0]), vsubq_u32(a.v[1], b.v[1]),
+                 vsubq_u32(a.v[2], b.v[2]), vsubq_u32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc mul(const Acc &a, uint32_t factor)
+    {
+        return {{vmulq_n_u32(a.v[0], factor), vmulq_n_u32(a.v[1], factor),
+                 vmulq_n_u32(a.v[2], factor), vmulq_n_u32(a.v[3], factor)}};
+    }
+
+    static inline Acc scale(const Acc &a, uint32_t reciprocal)
+    {
+        const Acc m = mul(a, reciprocal);
+        return {{vshrq_n_u32(m.v[0], 24), vshrq_n_u32(m.v[1], 24),
+                 vshrq_n_u32(m.v[2], 24), vshrq_n_u32(m.v[3], 24)}};
+    }
+};
+
+void boxBlurColumnsNeon(const uint8_t *src, uint8_t *dst, int length, ptrdiff_t inputStride, ptrdiff_t outputStride, int lobeLeft, int lobeRight)
+{
+    boxBlurColumns<NeonLanes>(src, dst, length, inputStride, outputStride, lobeLeft, lobeRight);
+}
+
+#endif
+
+BoxBlurColumnsKernel selectBoxBlurColumnsKernel()
+{
+    if (qEnvironmentVariableIsSet("MATERIAL_DECORATION_SCALAR_BLUR")) {
+        return {};
+    }
+
+#if HAVE_BLUR_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", 32, &boxBlurColumnsAvx2};
+    }
+#endif
+
+#if defined(__SSE2__)
+    return {"sse2", Sse2Lanes::Width, &boxBlurColumnsSse2};
+#elif defined(__ARM_NEON)
+    return {"neon", NeonLanes::Width, &boxBlurColumnsNeon};
+#else
+    return {};
+#endif
+}
+
+} // anonymous namespace
+
+const BoxBlurColumnsKernel &boxBlurColumnsKernel()
+{
+    static const BoxBlurColumnsKernel s_kernel = [] {
+        const BoxBlurColumnsKernel kernel = selectBoxBlurColumnsKernel();
+        qCDebug(category) << "Shadow blur kernel:" << kernel.name;
+        return kernel;
+    }();
+    return s_kernel;
+}
+
+} // namespace Material
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// own
+#include "BuildConfig.h"
+
+// std
+#include <cstddef>
+#include <cstdint>
+
+namespace Material
+{
+
+/**
+ * Run one box filter down several adjacent columns of a packed 8-bit plane.
+ *
+ * Every column is filtered exactly like the scalar boxBlurRowAlpha() in
+ * BoxShadowHelper.cc, so the results are identical bit for bit.
+ *
+ * @param src The first byte of the first column.
+ * @param dst The first byte of the first output column.
+ * @param length The number of pixels in each column. Must be at least
+ *    lobeLeft + 1 + lobeRight.
+ * @param inputStride The number of bytes from one row of @p src to the next.
+ * @param outputStride The number of bytes from one row of @p dst to the next.
+ * @param lobeLeft How many pixels to sample above.
+ * @param lobeRight How many pixels to sample below.
+ **/
+using BoxBlurColumnsFunc = void (*)(const uint8_t *src,
+                                    uint8_t *dst,
+                                    int length,
+                                    ptrdiff_t inputStride,
+                                    ptrdiff_t outputStride,
+                                    int lobeLeft,
+                                    int lobeRight);
+
+struct BoxBlurColumnsKernel {
+    const char *name = "scalar";
+    int lanes = 0; ///< how many columns a single call processes, 0 if there is no vector kernel
+    BoxBlurColumnsFunc blur = nullptr;
+};
+
+/**
+ * The best vector kernel for the running CPU, selected once at runtime.
+ *
+ * Setting MATERIAL_DECORATION_SCALAR_BLUR in the environment forces the
+ * scalar reference implementation.
+ **/
+const BoxBlurColumnsKernel &boxBlurColumnsKernel();
+
+#if HAVE_BLUR_AVX2
+void boxBlurColumnsAvx2(const uint8_t *src,
+                        uint8_t *dst,
+                        int length,
+                        ptrdiff_t inputStride,
+                        ptrdiff_t outputStride,
+                        int lobeLeft,
+                        int lobeRight);
+#endif
+
+} // namespace Material
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file is compiled with -mavx2 and only called after a runtime CPU
+// check, so it must not include Qt or other headers with inline functions
+// that could leak AVX2 code into the rest of the plugin.
+
+// own
+#include "BoxBlur.h"
+#include "BoxBlurColumns.h"
+
+#include <immintrin.h>
+
+namespace Material
+{
+namespace
+{
+
+// 32 columns per call, as four vectors of eight 32-bit sums.
+struct Avx2Lanes {
+    struct Acc {
+        __m256i v[4];
+    };
+
+    static inline Acc set1(uint32_t value)
+    {
+        const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+        return {{v, v, v, v}};
+    }
+
+    static inline Acc load(const uint8_t *p)
+    {
+        return {{_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))),
+                 _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + 8))),
+                 _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + 16))),
+                 _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + 24)))}};
+    }
+
+    static inline void store(uint8_t *p, const Acc &a)
+    {
+        // The AVX2 packs work within 128-bit halves, restore the column
+        // order with a cross-lane permute after each step.
+        const __m256i lo = _mm256_permute4x64_epi64(_mm256_packus_epi32(a.v[0], a.v[1]), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i hi = _mm256_permute4x64_epi64(_mm256_packus_epi32(a.v[2], a.v[3]), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), bytes);
+    }
+
+    static inline Acc add(const Acc &a, const Acc &b)
+    {
+        return {{_mm256_add_epi32(a.v[0], b.v[0]), _mm256_add_epi32(a.v[1], b.v[1]),
+                 _mm256_add_epi32(a.v[2], b.v[2]), _mm256_add_epi32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc sub(const Acc &a, const Acc &b)
+    {
+        return {{_mm256_sub_epi32(a.v[0], b.v[0]), _mm256_sub_epi32(a.v[1], b.v[1]),
+                 _mm256_sub_epi32(a.v[2], b.v[2]), _mm256_sub_epi32(a.v[3], b.v[3])}};
+    }
+
+    static inline Acc mul(const Acc &a, uint32_t factor)
+    {
+        const __m256i f = _mm256_set1_epi32(static_cast<int>(factor));
+        return {{_mm256_mullo_epi32(a.v[0], f), _mm256_mullo_epi32(a.v[1], f),
+                 _mm256_mullo_epi32(a.v[2], f), _mm256_mullo_epi32(a.v[3], f)}};
+    }
+
+    static inline Acc scale(const Acc &a, uint32_t reciprocal)
+    {
+        const Acc m = mul(a, reciprocal);
+        return {{_mm256_srli_epi32(m.v[0], 24), _mm256_srli_epi32(m.v[1], 24),
+                 _mm256_srli_epi32(m.v[2], 24), _mm256_srli_epi32(m.v[3], 24)}};
+    }
+};
+
+} // anonymous namespace
+
+void boxBlurColumnsAvx2(const uint8_t *src, uint8_t *dst, int length, ptrdiff_t inputStride, ptrdiff_t outputStride, int lobeLeft, int lobeRight)
+{
+    boxBlurColumns<Avx2Lanes>(src, dst, length, inputStride, outputStride, lobeLeft, lobeRight);
+}
+
+} // namespace Material
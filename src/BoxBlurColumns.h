@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Private header, only included by the box blur kernel translation units.
+// Everything lives in an anonymous namespace so that the copies compiled with
+// different instruction sets never get merged by the linker.
+
+// std
+#include <cstddef>
+#include <cstdint>
+
+namespace Material
+{
+namespace
+{
+
+/**
+ * Vectorized version of boxBlurRowAlpha().
+ *
+ * @p Lanes provides the vector type and operations. Each lane holds the
+ * 32-bit running sum of one column, and wraps around exactly like the
+ * uint32_t accumulator of the scalar kernel.
+ **/
+template<typename Lanes>
+inline void boxBlurColumns(const uint8_t *src,
+                           uint8_t *dst,
+                           int length,
+                           ptrdiff_t inputStride,
+                           ptrdiff_t outputStride,
+                           int lobeLeft,
+                           int lobeRight)
+{
+    using Acc = typename Lanes::Acc;
+
+    const int boxSize = lobeLeft + 1 + lobeRight;
+    const uint32_t reciprocal = (1 << 24) / boxSize;
+
+    const Acc firstValue = Lanes::load(src);
+    const Acc lastValue = Lanes::load(src + (length - 1) * inputStride);
+
+    Acc alphaSum = Lanes::set1((boxSize + 1) / 2);
+    alphaSum = Lanes::add(alphaSum, Lanes::mul(firstValue, lobeLeft));
+
+    int right = 0;
+    for (; right < boxSize - lobeLeft; ++right) {
+        alphaSum = Lanes::add(alphaSum, Lanes::load(src + right * inputStride));
+    }
+
+    uint8_t *out = dst;
+    for (; right < boxSize; ++right, out += outputStride) {
+        Lanes::store(out, Lanes::scale(alphaSum, reciprocal));
+        alphaSum = Lanes::sub(Lanes::add(alphaSum, Lanes::load(src + right * inputStride)), firstValue);
+    }
+
+    int left = 0;
+    for (; right < length; ++right, ++left, out += outputStride) {
+        Lanes::store(out, Lanes::scale(alphaSum, reciprocal));
+        alphaSum = Lanes::sub(Lanes::add(alphaSum, Lanes::load(src + right * inputStride)),
+                              Lanes::load(src + left * inputStride));
+    }
+
+    uint8_t *const outEnd = dst + length * outputStride;
+    for (; out < outEnd; ++left, out += outputStride) {
+        Lanes::store(out, Lanes::scale(alphaSum, reciprocal));
+        alphaSum = Lanes::sub(Lanes::add(alphaSum, lastValue), Lanes::load(src + left * inputStride));
+    }
+}
+
+} // anonymous namespace
+} // namespace Material
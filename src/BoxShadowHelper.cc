@@ -19,9 +19,11 @@
 
 // own
 #include "BoxShadowHelper.h"
+#include "BoxBlur.h"
 
 // Qt
 #include <QPainter>
+#include <QVarLengthArray>
 #include <QtMath>
 
 // std
@@ -31,6 +33,7 @@
 #include <memory>
 #include <new>
 #include <utility>
+#include <vector>
 
 namespace Material
 {
@@ -173,15 +176,119 @@ static inline void boxBlurRowAlpha(const uint8_t *src,
 }
 
 /**
- * Blur the alpha channel of a given image.
+ * Run the three box filters down every column of a packed 8-bit plane.
  *
- * @param image The input image.
+ * Groups of adjacent columns go through the vector kernel, the remaining
+ * ones through the scalar boxBlurRowAlpha().
+ *
+ * @param plane The first byte of the plane.
+ * @param stride The number of bytes from one row to the next.
+ * @param columns The number of columns.
+ * @param length The number of rows.
+ * @param lobes Params of the three box filters.
+ * @param buf1 Scratch buffer of at least length * kernel.lanes bytes.
+ * @param buf2 Scratch buffer of at least length * kernel.lanes bytes.
+ **/
+static void boxBlurColumnsAlpha(uint8_t *plane,
+                                int stride,
+                                int columns,
+                                int length,
+                                const QVector<BoxLobes> &lobes,
+                                const BoxBlurColumnsKernel &kernel,
+                                uint8_t *buf1,
+                                uint8_t *buf2)
+{
+    int x = 0;
+
+    const int lanes = kernel.lanes;
+    for (; x + lanes <= columns; x += lanes) {
+        uint8_t *column = plane + x;
+        kernel.blur(column, buf1, length, stride, lanes, lobes[0].left, lobes[0].right);
+        kernel.blur(buf1, buf2, length, lanes, lanes, lobes[1].left, lobes[1].right);
+        kernel.blur(buf2, column, length, lanes, stride, lobes[2].left, lobes[2].right);
+    }
+
+    for (; x < columns; ++x) {
+        uint8_t *column = plane + x;
+        boxBlurRowAlpha(column, buf1, length, 1, stride, lobes[0], true, false);
+        boxBlurRowAlpha(buf1, buf2, length, 1, stride, lobes[1], false, false);
+        boxBlurRowAlpha(buf2, column, length, 1, stride, lobes[2], false, true);
+    }
+}
+
+/**
+ * Vectorized counterpart of the scalar passes in boxBlurAlpha().
+ *
+ * The vector kernels filter many columns at once, so the horizontal pass is
+ * done as a vertical one on a transposed copy of the plane. The result is
+ * identical to the scalar passes.
+ *
+ * @returns false if the scratch memory could not be allocated.
+ **/
+static bool boxBlurAlphaVectorized(uint8_t *bits, int rowStride, int width, int height, const QVector<BoxLobes> &lobes, const BoxBlurColumnsKernel &kernel)
+{
+    const size_t planeSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+    const size_t bufferStride = static_cast<size_t>(qMax(width, height)) * static_cast<size_t>(kernel.lanes);
+
+    std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[planeSize + 2 * bufferStride]);
+    if (!buf) {
+        return false;
+    }
+
+    uint8_t *transposed = buf.get(); // width rows of height bytes
+    uint8_t *buf1 = transposed + planeSize;
+    uint8_t *buf2 = buf1 + bufferStride;
+
+    // Walk in square tiles so that both sides of the transpose stay in cache.
+    constexpr int tileSize = 32;
+
+    for (int ty = 0; ty < height; ty += tileSize) {
+        const int tyEnd = qMin(ty + tileSize, height);
+        for (int tx = 0; tx < width; tx += tileSize) {
+            const int txEnd = qMin(tx + tileSize, width);
+            for (int y = ty; y < tyEnd; ++y) {
+                const uint8_t *in = bits + static_cast<size_t>(y) * rowStride;
+                for (int x = tx; x < txEnd; ++x) {
+                    transposed[static_cast<size_t>(x) * height + y] = in[x];
+                }
+            }
+        }
+    }
+
+    // Horizontal direction: the rows of the image are the columns of the transposed plane.
+    boxBlurColumnsAlpha(transposed, height, height, width, lobes, kernel, buf1, buf2);
+
+    for (int tx = 0; tx < width; tx += tileSize) {
+        const int txEnd = qMin(tx + tileSize, width);
+        for (int ty = 0; ty < height; ty += tileSize) {
+            const int tyEnd = qMin(ty + tileSize, height);
+            for (int x = tx; x < txEnd; ++x) {
+                const uint8_t *in = transposed + static_cast<size_t>(x) * height;
+                for (int y = ty; y < tyEnd; ++y) {
+                    bits[static_cast<size_t>(y) * rowStride + x] = in[y];
+                }
+            }
+        }
+    }
+
+    // Vertical direction, in place.
+    boxBlurColumnsAlpha(bits, rowStride, width, height, lobes, kernel, buf1, buf2);
+
+    return true;
+}
+
+/**
+ * Blur an alpha mask.
+ *
+ * @param image The input mask, in QImage::Format_Alpha8.
  * @param radius The blur radius.
  * @param rect Specifies what part of the image to blur. If nothing is provided, then
- *    the whole alpha channel of the input image will be blurred.
+ *    the whole mask will be blurred.
  **/
 static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {})
 {
+    Q_ASSERT(image.format() == QImage::Format_Alpha8);
+
     if (radius < 2 || radius > 512) {
         return;
     }
@@ -190,7 +297,6 @@ static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {
 
     const QRect blurRect = (rect.isNull() ? image.rect() : rect).intersected(image.rect());
 
-    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
     const int width = blurRect.width();
     const int height = blurRect.height();
 
@@ -201,25 +307,22 @@ static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {
     }
 
     const int rowStride = image.bytesPerLine();
-    const int pixelStride = image.depth() >> 3;
+    uint8_t *bits = image.scanLine(blurRect.y()) + blurRect.x();
 
-    if (pixelStride <= 0 || pixelStride > 32) {
-        return;
+    // The vector kernels need at least one full box of samples per column.
+    const BoxBlurColumnsKernel &kernel = boxBlurColumnsKernel();
+    int maxBoxSize = 0;
+    for (const BoxLobes &lobe : lobes) {
+        maxBoxSize = qMax(maxBoxSize, lobe.left + 1 + lobe.right);
     }
-
-    size_t bufferStride;
-    if (qMulOverflow(static_cast<size_t>(qMax(width, height)),
-                     static_cast<size_t>(pixelStride),
-                     &bufferStride)) {
+    if (kernel.blur && qMin(width, height) >= maxBoxSize
+        && boxBlurAlphaVectorized(bits, rowStride, width, height, lobes, kernel)) {
         return;
     }
 
-    size_t totalSize;
-    if (qMulOverflow(static_cast<size_t>(2), bufferStride, &totalSize)) {
-        return;
-    }
+    const size_t bufferStride = static_cast<size_t>(qMax(width, height));
 
-    std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[totalSize]);
+    std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[2 * bufferStride]);
     if (!buf) {
         return;
     }
@@ -229,97 +332,234 @@ static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {
 
     // Blur the image in horizontal direction.
     for (int i = 0; i < height; ++i) {
-        uint8_t *row = image.scanLine(blurRect.y() + i) + blurRect.x() * pixelStride + alphaOffset;
-        boxBlurRowAlpha(row, buf1, width, pixelStride, rowStride, lobes[0], false, false);
-        boxBlurRowAlpha(buf1, buf2, width, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, row, width, pixelStride, rowStride, lobes[2], false, false);
+        uint8_t *row = bits + static_cast<size_t>(i) * rowStride;
+        boxBlurRowAlpha(row, buf1, width, 1, rowStride, lobes[0], false, false);
+        boxBlurRowAlpha(buf1, buf2, width, 1, rowStride, lobes[1], false, false);
+        boxBlurRowAlpha(buf2, row, width, 1, rowStride, lobes[2], false, false);
     }
 
     // Blur the image in vertical direction.
     for (int i = 0; i < width; ++i) {
-        uint8_t *column = image.scanLine(blurRect.y()) + (blurRect.x() + i) * pixelStride + alphaOffset;
-        boxBlurRowAlpha(column, buf1, height, pixelStride, rowStride, lobes[0], true, false);
-        boxBlurRowAlpha(buf1, buf2, height, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, column, height, pixelStride, rowStride, lobes[2], false, true);
+        uint8_t *column = bits + i;
+        boxBlurRowAlpha(column, buf1, height, 1, rowStride, lobes[0], true, false);
+        boxBlurRowAlpha(buf1, buf2, height, 1, rowStride, lobes[1], false, false);
+        boxBlurRowAlpha(buf2, column, height, 1, rowStride, lobes[2], false, true);
     }
 }
 
-static inline void mirrorTopLeftQuadrant(QImage &image)
+/**
+ * Multiply an 8-bit value by an 8-bit alpha, rounded like Qt's raster engine.
+ **/
+static inline uint multiplyByAlpha(uint value, uint alpha)
+{
+    const uint t = value * alpha + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+/**
+ * One shadow layer, before it is tinted and composited.
+ *
+ * The mask is symmetric in both directions, so only its top-left quadrant
+ * is stored; the other three are read through mirrored coordinates.
+ **/
+struct ShadowLayer {
+    QImage quadrant; ///< in QImage::Format_Alpha8
+    QSize size; ///< of the whole mask, in device pixels
+    QPoint topLeft; ///< where the mask goes on the canvas, in device pixels
+    QColor color;
+};
+
+/**
+ * Tint a shadow layer and composite it over the first @p columns columns of @p canvas.
+ *
+ * This is the only place where the shadow turns into premultiplied ARGB.
+ *
+ * @param canvas The destination, in QImage::Format_ARGB32_Premultiplied.
+ * @param layer The layer to composite.
+ * @param columns How many columns of the canvas to touch.
+ **/
+static void compositeLayer(QImage &canvas, const ShadowLayer &layer, int columns)
 {
-    if (image.isNull()) {
+    Q_ASSERT(canvas.format() == QImage::Format_ARGB32_Premultiplied);
+    Q_ASSERT(layer.quadrant.format() == QImage::Format_Alpha8);
+
+    const QRect target = QRect(layer.topLeft, layer.size).intersected(QRect(0, 0, columns, canvas.height()));
+    if (target.isEmpty()) {
         return;
     }
 
-    const int width = image.width();
-    const int height = image.height();
-
-    const int centerY = qCeil(height * 0.5);
-
-    const int stride = image.depth() >> 3;
-
-    if (stride == 4) {
-        const int halfWidth = width / 2;
-        const int destOffset = width - halfWidth;
-        // Proof of non-overlapping ranges for std::reverse_copy:
-        // - Source range is [row, row + halfWidth).
-        // - Destination range is [row + destOffset, row + destOffset + halfWidth).
-        // Since halfWidth = width / 2 and destOffset = width - halfWidth, we have:
-        //   destOffset >= halfWidth for all integers width >= 0.
-        // Therefore, the destination range starts exactly where the source range ends (if even)
-        // or strictly after it (if odd), ensuring they never overlap.
-        Q_ASSERT(destOffset >= halfWidth);
-        for (int y = 0; y < centerY; ++y) {
-            uint32_t *row = reinterpret_cast<uint32_t *>(image.scanLine(y));
-            std::reverse_copy(row, row + halfWidth, row + destOffset);
-        }
-    } else {
-        for (int y = 0; y < centerY; ++y) {
-            uint8_t *row = image.scanLine(y);
-            const uint8_t *in = row;
-            uint8_t *out = row + (width - 1) * stride;
-
-            for (int x = 0; x < width / 2; ++x, in += stride, out -= stride) {
-                std::copy_n(in, stride, out);
+    const QRgb premultiplied = qPremultiply(layer.color.rgba());
+    const uint colorAlpha = qAlpha(premultiplied);
+    const uint colorRed = qRed(premultiplied);
+    const uint colorGreen = qGreen(premultiplied);
+    const uint colorBlue = qBlue(premultiplied);
+
+    const int quadrantWidth = layer.quadrant.width();
+    const int quadrantHeight = layer.quadrant.height();
+
+    for (int y = target.top(); y <= target.bottom(); ++y) {
+        const int maskY = y - layer.topLeft.y();
+        const uint8_t *in = layer.quadrant.constScanLine(maskY < quadrantHeight ? maskY : layer.size.height() - 1 - maskY);
+        QRgb *out = reinterpret_cast<QRgb *>(canvas.scanLine(y)) + target.left();
+
+        for (int x = target.left(); x <= target.right(); ++x, ++out) {
+            const int maskX = x - layer.topLeft.x();
+            const uint coverage = in[maskX < quadrantWidth ? maskX : layer.size.width() - 1 - maskX];
+            if (!coverage) {
+                continue;
             }
+
+            // Source over: dst = src + dst * (1 - src.alpha).
+            const uint srcAlpha = multiplyByAlpha(colorAlpha, coverage);
+            const uint inverse = 255 - srcAlpha;
+            const QRgb dst = *out;
+            *out = qRgba(multiplyByAlpha(colorRed, coverage) + multiplyByAlpha(qRed(dst), inverse),
+                         multiplyByAlpha(colorGreen, coverage) + multiplyByAlpha(qGreen(dst), inverse),
+                         multiplyByAlpha(colorBlue, coverage) + multiplyByAlpha(qBlue(dst), inverse),
+                         srcAlpha + multiplyByAlpha(qAlpha(dst), inverse));
         }
     }
+}
 
-    const int bpl = image.bytesPerLine();
-    const int halfHeight = height / 2;
-    for (int y = 0; y < halfHeight; ++y) {
-        const uint8_t *in = image.constScanLine(y);
-        uint8_t *out = image.scanLine(height - y - 1);
-        std::copy_n(in, bpl, out);
+/**
+ * Copy the left half of every row of @p image onto its right half, mirrored.
+ **/
+static void mirrorLeftHalf(QImage &image)
+{
+    Q_ASSERT(image.depth() == 32);
+
+    const int width = image.width();
+    const int halfWidth = width / 2;
+    const int destOffset = width - halfWidth;
+    // Source [row, row + halfWidth) and destination [row + destOffset, row + width)
+    // never overlap, because destOffset >= halfWidth.
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *row = reinterpret_cast<QRgb *>(image.scanLine(y));
+        std::reverse_copy(row, row + halfWidth, row + destOffset);
     }
 }
 
-static void renderShadow(QPainter *painter, const QRectF &rect, qreal borderRadius, const QPointF &offset, double radius, const QColor &color)
+/**
+ * Fill the top-left quadrant of a shadow mask with the Gaussian shadow of a
+ * rounded rectangle, evaluated in closed form instead of rasterized and blurred.
+ *
+ * The box is cut into horizontal slices: the straight middle band and thin
+ * slices through the rounded corners. A Gaussian integrates over each slice
+ * separably with erf(), so the shadow is a sum of products of a per-row and
+ * a per-column weight. Both weights are tabulated once, which keeps the cost
+ * per pixel independent of the blur radius.
+ *
+ * @param quadrant The quadrant, in QImage::Format_Alpha8.
+ * @param box The rectangle casting the shadow, in device pixels.
+ * @param cornerRadius The radius of the box' corners, in device pixels.
+ * @param stdDev The standard deviation of the Gaussian, in device pixels.
+ **/
+static void renderAnalyticQuadrant(QImage &quadrant, const QRectF &box, qreal cornerRadius, qreal stdDev)
 {
-    if (!painter->isActive()) {
-        return;
+    Q_ASSERT(quadrant.format() == QImage::Format_Alpha8);
+    Q_ASSERT(stdDev > 0);
+
+    const int width = quadrant.width();
+    const int height = quadrant.height();
+
+    const double left = box.left();
+    const double right = box.right();
+    const double top = box.top();
+    const double bottom = box.bottom();
+    const double radius = qBound(0.0, double(cornerRadius), qMin(box.width(), box.height()) * 0.5);
+
+    const double scale = 1.0 / (stdDev * std::sqrt(2.0));
+    auto gaussianIntegral = [scale](double from, double to, double at) {
+        return 0.5 * (std::erf((to - at) * scale) - std::erf((from - at) * scale));
+    };
+
+    struct Slice {
+        double top;
+        double bottom;
+        double inset;
+    };
+
+    QVarLengthArray<Slice, 129> slices;
+    slices.append({top + radius, bottom - radius, 0.0});
+    if (radius > 0) {
+        // One slice per device pixel of corner height is plenty.
+        const int steps = qBound(1, qCeil(radius), 64);
+        const double step = radius / steps;
+        for (int i = 0; i < steps; ++i) {
+            const double distance = radius - (i + 0.5) * step;
+            const double inset = radius - std::sqrt(radius * radius - distance * distance);
+            slices.append({top + i * step, top + (i + 1) * step, inset});
+            slices.append({bottom - (i + 1) * step, bottom - i * step, inset});
+        }
     }
 
+    const int sliceCount = slices.size();
+    std::vector<float> columnWeights(static_cast<size_t>(sliceCount) * width);
+    std::vector<float> rowWeights(static_cast<size_t>(sliceCount) * height);
+    for (int k = 0; k < sliceCount; ++k) {
+        const Slice &slice = slices[k];
+        float *columns = columnWeights.data() + static_cast<size_t>(k) * width;
+        for (int x = 0; x < width; ++x) {
+            columns[x] = gaussianIntegral(left + slice.inset, right - slice.inset, x + 0.5);
+        }
+        float *rows = rowWeights.data() + static_cast<size_t>(k) * height;
+        for (int y = 0; y < height; ++y) {
+            rows[y] = gaussianIntegral(slice.top, slice.bottom, y + 0.5);
+        }
+    }
+
+    std::vector<float> accumulator(width);
+    for (int y = 0; y < height; ++y) {
+        std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+        for (int k = 0; k < sliceCount; ++k) {
+            const float rowWeight = rowWeights[static_cast<size_t>(k) * height + y];
+            if (rowWeight < 1e-6f) {
+                continue;
+            }
+            const float *columns = columnWeights.data() + static_cast<size_t>(k) * width;
+            for (int x = 0; x < width; ++x) {
+                accumulator[x] += rowWeight * columns[x];
+            }
+        }
+
+        uint8_t *out = quadrant.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            out[x] = static_cast<uint8_t>(qBound(0, qRound(accumulator[x] * 255.0f), 255));
+        }
+    }
+}
+
+static ShadowLayer renderShadow(const QRectF &rect,
+                               qreal dpr,
+                               qreal borderRadius,
+                               const QPointF &offset,
+                               double radius,
+                               const QColor &color,
+                               BoxShadowRenderer::Algorithm algorithm)
+{
     if (std::isnan(radius) || std::isinf(radius) || radius < 0 || radius > 512) {
-        return;
+        return {};
     }
 
-    const qreal dpr = painter->device()->devicePixelRatioF();
     if (rect.width() <= 0 || rect.height() <= 0 || rect.width() > 20000 || rect.height() > 20000) {
-        return;
+        return {};
     }
 
     const QSize inflation = calculateBlurExtent(radius);
     const QSize pixelSize = ((rect.size() + 2 * inflation) * dpr).toSize();
     // Limit shadow dimensions to prevent excessive memory usage or overflow.
     if (pixelSize.width() <= 0 || pixelSize.height() <= 0 || pixelSize.width() > 20000 || pixelSize.height() > 20000) {
-        return;
+        return {};
     }
 
     const QSizeF size = QSizeF(pixelSize) / dpr;
 
-    QImage shadow(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    // Because the shadow texture is symmetrical, that's enough to render
+    // only the top-left quadrant. Only the coverage matters until the very
+    // end, so keep it in a single byte per pixel.
+    QImage shadow(qCeil(pixelSize.width() * 0.5), qCeil(pixelSize.height() * 0.5), QImage::Format_Alpha8);
     shadow.setDevicePixelRatio(dpr);
-    shadow.fill(Qt::transparent);
+    shadow.fill(0);
 
     QRectF boxRect(QPoint(0, 0), rect.size());
     boxRect.moveCenter(QRectF(QPoint(0, 0), size).center());
@@ -327,34 +567,34 @@ static void renderShadow(QPainter *painter, const QRectF &rect, qreal borderRadi
     const qreal xRadius = 2.0 * borderRadius / boxRect.width();
     const qreal yRadius = 2.0 * borderRadius / boxRect.height();
 
-    QPainter shadowPainter;
-    if (!shadowPainter.begin(&shadow)) {
-        return;
+    const int scaledRadius = qRound(radius * dpr);
+
+    if (algorithm == BoxShadowRenderer::Algorithm::Analytic && scaledRadius >= 2) {
+        // Same rounded rect as drawRoundedRect() below, whose radii are absolute.
+        const QRectF deviceBoxRect(boxRect.topLeft() * dpr, boxRect.size() * dpr);
+        renderAnalyticQuadrant(shadow, deviceBoxRect, qMin(xRadius, yRadius) * dpr, calculateBlurStdDev(scaledRadius));
+    } else {
+        QPainter shadowPainter;
+        if (!shadowPainter.begin(&shadow)) {
+            return {};
+        }
+        shadowPainter.setRenderHint(QPainter::Antialiasing);
+        shadowPainter.setPen(Qt::NoPen);
+        shadowPainter.setBrush(Qt::black);
+        shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
+        shadowPainter.end();
+
+        boxBlurAlpha(shadow, scaledRadius);
     }
-    shadowPainter.setRenderHint(QPainter::Antialiasing);
-    shadowPainter.setPen(Qt::NoPen);
-    shadowPainter.setBrush(Qt::black);
-    shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
-    shadowPainter.end();
 
-    // Because the shadow texture is symmetrical, that's enough to blur
-    // only the top-left quadrant and then mirror it.
-    const QRect blurRect(0, 0, qCeil(shadow.width() * 0.5), qCeil(shadow.height() * 0.5));
-    const int scaledRadius = qRound(radius * dpr);
-    boxBlurAlpha(shadow, scaledRadius, blurRect);
-    mirrorTopLeftQuadrant(shadow);
-
-    // Give the shadow a tint of the desired color.
-    shadowPainter.begin(&shadow);
-    shadowPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-    shadowPainter.fillRect(shadow.rect(), color);
-    shadowPainter.end();
-
-    // Actually, present the shadow.
-    QRectF shadowRect = shadow.rect();
-    shadowRect.setSize(shadowRect.size() / dpr);
-    shadowRect.moveCenter(rect.center() + offset);
-    painter->drawImage(shadowRect, shadow);
+    const QPointF center = (rect.center() + offset) * dpr;
+
+    ShadowLayer layer;
+    layer.quadrant = shadow;
+    layer.size = pixelSize;
+    layer.topLeft = QPoint(qRound(center.x() - pixelSize.width() * 0.5), qRound(center.y() - pixelSize.height() * 0.5));
+    layer.color = color;
+    return layer;
 }
 
 void BoxShadowRenderer::setBoxSize(const QSizeF &size)
@@ -367,6 +607,11 @@ void BoxShadowRenderer::setBorderRadius(qreal radius)
     m_borderRadius = radius;
 }
 
+void BoxShadowRenderer::setAlgorithm(Algorithm algorithm)
+{
+    m_algorithm = algorithm;
+}
+
 void BoxShadowRenderer::addShadow(const QPointF &offset, double radius, const QColor &color)
 {
     Shadow shadow = {};
@@ -393,11 +638,26 @@ QImage BoxShadowRenderer::render() const
     QRectF boxRect(QPoint(0, 0), m_boxSize);
     boxRect.moveCenter(QRect(QPoint(0, 0), canvas.size()).center());
 
-    QPainter painter(&canvas);
+    QVarLengthArray<ShadowLayer, 2> layers;
+    bool symmetric = true;
     for (const Shadow &shadow : std::as_const(m_shadows)) {
-        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color);
+        ShadowLayer layer = renderShadow(boxRect, canvas.devicePixelRatioF(), m_borderRadius, shadow.offset, shadow.radius, shadow.color, m_algorithm);
+        if (layer.quadrant.isNull()) {
+            continue;
+        }
+        symmetric = symmetric && 2 * layer.topLeft.x() + layer.size.width() == canvas.width();
+        layers.append(layer);
+    }
+
+    // Shadows are usually only offset vertically. Then the canvas is
+    // symmetric too, and it is enough to composite its left half.
+    const int columns = symmetric ? qCeil(canvas.width() * 0.5) : canvas.width();
+    for (const ShadowLayer &layer : std::as_const(layers)) {
+        compositeLayer(canvas, layer, columns);
+    }
+    if (symmetric) {
+        mirrorLeftHalf(canvas);
     }
-    painter.end();
 
     return canvas;
 }
@@ -31,6 +31,13 @@ class BoxShadowRenderer
 public:
     // Compiler generated constructors & destructor are fine.
 
+    enum class Algorithm {
+        /// Rasterize the box and approximate a Gaussian blur with three box filters.
+        BoxBlur,
+        /// Evaluate the Gaussian shadow of the rounded box in closed form.
+        Analytic,
+    };
+
     /**
      * Set the size of the box.
      * @param size The size of the box.
@@ -43,6 +50,12 @@ public:
      **/
     void setBorderRadius(qreal radius);
 
+    /**
+     * Set how the shadow is generated.
+     * @param algorithm The algorithm, BoxBlur by default.
+     **/
+    void setAlgorithm(Algorithm algorithm);
+
     /**
      * Add a shadow.
      * @param offset The offset of the shadow.
@@ -81,6 +94,7 @@ public:
 private:
     QSizeF m_boxSize;
     qreal m_borderRadius = 0.0;
+    Algorithm m_algorithm = Algorithm::BoxBlur;
 
     struct Shadow {
         QPointF offset;
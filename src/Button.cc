@@ -22,6 +22,7 @@
 #include "Button.h"
 #include "Material.h"
 #include "Decoration.h"
+#include "GlyphCache.h"
 
 #include "AppIconButton.h"
 #include "ApplicationMenuButton.h"
@@ -53,15 +54,17 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QHoverEvent>
+#include <QImage>
 #include <QMouseEvent>
 #include <QPainter>
-#include <QVariantAnimation>
 #include <QTimer>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <cmath>
 
-#define UPDATE_GEOM() update(geometry().adjusted(-1, -1, 1, 1))
+// Through the AnimationTicker, so that repaints during a transition frame
+// are merged per decoration.
+#define UPDATE_GEOM() AnimationTicker::self()->update(decoration(), geometry().adjusted(-1, -1, 1, 1))
 
 
 namespace Material
@@ -80,12 +83,33 @@ Decoration *decorationFromArgs(const QVariantList &args)
     return args.value(1).value<Decoration *>();
 }
 
+// Buttons whose icon is one of the vector glyphs drawn by paintGlyph().
+bool hasGlyph(KDecoration3::DecorationButtonType type)
+{
+    switch (type) {
+    case KDecoration3::DecorationButtonType::OnAllDesktops:
+    case KDecoration3::DecorationButtonType::ContextHelp:
+    case KDecoration3::DecorationButtonType::Shade:
+    case KDecoration3::DecorationButtonType::KeepAbove:
+    case KDecoration3::DecorationButtonType::KeepBelow:
+    case KDecoration3::DecorationButtonType::Close:
+    case KDecoration3::DecorationButtonType::Maximize:
+    case KDecoration3::DecorationButtonType::Minimize:
+#if HAVE_EXCLUDE_FROM_CAPTURE
+    case KDecoration3::DecorationButtonType::ExcludeFromCapture:
+#endif
+        return true;
+    default:
+        return false;
+    }
+}
+
 }   
     
 Button::Button(KDecoration3::DecorationButtonType type, Decoration *decoration, QObject *parent)
     : DecorationButton(type, decoration, parent)
     , m_animationEnabled(true)
-    , m_animation(new QVariantAnimation(this))
+    , m_animation([this](qreal value) { setTransitionValue(value); })
     , m_opacity(1)
     , m_transitionValue(0)
     , m_padding()
@@ -112,15 +136,8 @@ Button::Button(KDecoration3::DecorationButtonType type, Decoration *decoration,
     // The GTK bridge needs animations disabled to render hover states. See Issue #50.
     // https://invent.kde.org/plasma/kde-gtk-config/-/blob/master/kded/kwin_bridge/dummydecorationbridge.cpp#L35
     m_animationEnabled = !m_isGtkButton && decoration->animationsEnabled();
-    m_animation->setDuration(decoration->animationsDuration());
-    m_animation->setStartValue(0.0);
-    m_animation->setEndValue(1.0);
-    m_animation->setEasingCurve(QEasingCurve::InOutCubic);
-    
-    
-    connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-        setTransitionValue(value.toReal());
-    });
+    m_animation.setDuration(decoration->animationsDuration());
+    m_animation.setEasingCurve(QEasingCurve::InOutCubic);
     
    
     connect(this, &Button::hoveredChanged, this, &Button::updateAnimationState);
@@ -141,13 +158,13 @@ Button::Button(KDecoration3::DecorationButtonType type, Decoration *decoration,
     
     connect(this, &Button::pressedChanged, this, [this]() {
         const auto *deco = qobject_cast<Decoration *>(this->decoration());
-        if (deco && deco->m_internalSettings->longPressEnabled() &&
+        if (deco && deco->m_internalSettings->longPressEnabled &&
             (this->type() == KDecoration3::DecorationButtonType::Close ||
             this->type() == KDecoration3::DecorationButtonType::Maximize ||
             this->type() == KDecoration3::DecorationButtonType::Minimize)) {
             if (isPressed()) {
                 m_longPressTriggered = false;
-                m_holdTimer->start(deco->m_internalSettings->longPressDuration());
+                m_holdTimer->start(deco->m_internalSettings->longPressDuration);
             } else {
                 m_holdTimer->stop();
             }
@@ -163,9 +180,10 @@ Button::Button(KDecoration3::DecorationButtonType type, Decoration *decoration,
     }); 
     
     connect(this, &Button::geometryChanged, this, [this]() {
-        UPDATE_GEOM();     
+        UPDATE_GEOM();
+        invalidateBackgroundCache();
         if (auto *deco = qobject_cast<Decoration *>(this->decoration())) {
-            QTimer::singleShot(0, this, [deco]() { deco->updateButtonsGeometry(); });
+            deco->updateButtonsGeometryDelayed();
         }
     });
     
@@ -309,13 +327,27 @@ void Button::paint(QPainter *painter, const QRectF &repaintRegion)
     painter->setRenderHints(QPainter::Antialiasing, m_isRightmost || m_isLeftmost);
     painter->setPen(Qt::NoPen);
     painter->setBrush(bgColor);
-    const qreal radius = deco->cornerRadius();
+    const qreal radius = deco->cornerRadius() - Material::cornerRadiusAdjustment;
+    const bool roundLeft = m_isLeftmost && deco->leftBorderVisible();
+    const bool roundRight = m_isRightmost && deco->rightBorderVisible();
 
     //const qreal offset = (static_cast<int>(m_isRightmost) - static_cast<int>(m_isLeftmost));   // -0.5 for left; +0.5 for right
 
-    // Smart way to draw a rectangle with the right rounded/squared corner
-    painter->drawPath(deco->getRoundedPath(geometry(), radius-Material::cornerRadiusAdjustment, m_isLeftmost && deco->leftBorderVisible(), m_isRightmost && deco->rightBorderVisible(), false, false));
-    //painter->fillRect(geometry().toAlignedRect(), bgColor); //.adjusted(-1, -1, 1, 1)
+    if ((!roundLeft && !roundRight) || radius <= 0) {
+        // Most buttons sit between two others and are just a rectangle
+        painter->fillRect(geometry(), bgColor);
+    } else {
+        // Smart way to draw a rectangle with the right rounded/squared corner
+        if (m_backgroundCache.geometry != geometry() || m_backgroundCache.radius != radius
+            || m_backgroundCache.roundLeft != roundLeft || m_backgroundCache.roundRight != roundRight) {
+            m_backgroundCache.geometry = geometry();
+            m_backgroundCache.radius = radius;
+            m_backgroundCache.roundLeft = roundLeft;
+            m_backgroundCache.roundRight = roundRight;
+            m_backgroundCache.path = deco->getRoundedPath(geometry(), radius, roundLeft, roundRight, false, false);
+        }
+        painter->drawPath(m_backgroundCache.path);
+    }
 
     // Foreground.
     painter->setRenderHint(QPainter::Antialiasing, true);
@@ -360,66 +392,117 @@ void Button::paint(QPainter *painter, const QRectF &repaintRegion)
         // Translate to a center aligned with physical pixel grid
         const QPointF center = contentRect.center();
         const QPointF centerSnapped = snapper.snap(center);
-        painter->translate(centerSnapped);
 
-        // Scale by physical-aligned factor
-        painter->scale(iconLogicalSize / 18.0, iconLogicalSize / 18.0);
-        
-        setPenWidth(painter, KDecoration3::pixelSize(deco->window()->scale()));
+        // The color only changes from one frame to the next while a hover
+        // transition runs, so don't fill the cache with those.
+        const bool inTransition = (isHovered() || isPressed()) && m_transitionValue > 0.0 && m_transitionValue < 1.0;
+        if (!m_isGtkButton && !inTransition && localToPhysicalScale > 0.0 && hasGlyph(type())) {
+            GlyphKey key;
+            key.buttonType = static_cast<int>(type());
+            key.checked = isChecked();
+            key.color = foregroundColor().rgba();
+            key.physicalSize = static_cast<int>(physicalIconSize);
+            key.devicePixelRatio = localToPhysicalScale;
+            key.windowScale = deco->window()->scale();
+
+            const QPixmap glyph = GlyphCache::self()->glyph(key, [&] {
+                return renderGlyph(iconLogicalSize, localToPhysicalScale, key.physicalSize);
+            });
+            // The glyph is centered on a pixel boundary, just like centerSnapped.
+            const qreal halfExtent = glyph.width() / (2.0 * localToPhysicalScale);
+            painter->drawPixmap(centerSnapped - QPointF(halfExtent, halfExtent), glyph);
+        } else {
+            painter->translate(centerSnapped);
+            paintGlyph(painter, iconLogicalSize);
+        }
+    }
+
+    painter->restore();
+}
+
+void Button::paintGlyph(QPainter *painter, qreal iconLogicalSize)
+{
+    const auto *deco = qobject_cast<Decoration *>(this->decoration());
+    if (!deco) {
+        return;
+    }
+
+    // Scale by physical-aligned factor
+    painter->scale(iconLogicalSize / 18.0, iconLogicalSize / 18.0);
 
-        PixelSnapper iconSnapper(painter);
+    setPenWidth(painter, KDecoration3::pixelSize(deco->window()->scale()));
 
-        // Icons
-        const QRectF iconRect(-9, -9, 18, 18);
-        switch (type()) {
-        // NOTE: Menu and ApplicationMenu are handled above
-        case KDecoration3::DecorationButtonType::OnAllDesktops:
-            OnAllDesktopsButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    PixelSnapper iconSnapper(painter);
 
-        case KDecoration3::DecorationButtonType::ContextHelp:
-            ContextHelpButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    // Icons
+    const QRectF iconRect(-9, -9, 18, 18);
+    switch (type()) {
+    // NOTE: Menu and ApplicationMenu are handled above
+    case KDecoration3::DecorationButtonType::OnAllDesktops:
+        OnAllDesktopsButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::Shade:
-            ShadeButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::ContextHelp:
+        ContextHelpButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::KeepAbove:
-            KeepAboveButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::Shade:
+        ShadeButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::KeepBelow:
-            KeepBelowButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::KeepAbove:
+        KeepAboveButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::Close:
-            CloseButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::KeepBelow:
+        KeepBelowButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::Maximize:
-            MaximizeButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::Close:
+        CloseButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 
-        case KDecoration3::DecorationButtonType::Minimize:
-            MinimizeButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
-        case KDecoration3::DecorationButtonType::Spacer:  
-            break;            
+    case KDecoration3::DecorationButtonType::Maximize:
+        MaximizeButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
+
+    case KDecoration3::DecorationButtonType::Minimize:
+        MinimizeButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
+    case KDecoration3::DecorationButtonType::Spacer:
+        break;
 
 #if HAVE_EXCLUDE_FROM_CAPTURE
-        case KDecoration3::DecorationButtonType::ExcludeFromCapture:
-            ExcludeFromCaptureButton::paintIcon(this, painter, iconRect, iconSnapper);
-            break;
+    case KDecoration3::DecorationButtonType::ExcludeFromCapture:
+        ExcludeFromCaptureButton::paintIcon(this, painter, iconRect, iconSnapper);
+        break;
 #endif
 
-        default:
-            paintIcon(painter, iconRect, iconSnapper);
-            break;
-        }
+    default:
+        paintIcon(painter, iconRect, iconSnapper);
+        break;
     }
+}
 
-    painter->restore();
+QPixmap Button::renderGlyph(qreal iconLogicalSize, qreal localToPhysicalScale, int physicalIconSize)
+{
+    // Even, so that the center falls on a pixel boundary, plus some room for the pen.
+    const int margin = 2;
+    const int extent = 2 * ((physicalIconSize + 1) / 2) + 2 * margin;
+
+    QImage image(extent, extent, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(localToPhysicalScale);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setBrush(Qt::NoBrush);
+    const qreal halfExtent = extent / (2.0 * localToPhysicalScale);
+    painter.translate(halfExtent, halfExtent);
+    paintGlyph(&painter, iconLogicalSize);
+    painter.end();
+
+    return QPixmap::fromImage(std::move(image));
 }
 
 void Button::paintIcon(QPainter *painter, const QRectF &iconRect, const PixelSnapper &snapper)
@@ -672,13 +755,13 @@ void Button::setAnimationEnabled(bool value)
 
 int Button::animationDuration() const
 {
-    return m_animation->duration();
+    return m_animation.duration();
 }
 
 void Button::setAnimationDuration(int value)
 {
-    if (m_animation->duration() != value) {
-        m_animation->setDuration(value);
+    if (m_animation.duration() != value) {
+        m_animation.setDuration(value);
         Q_EMIT animationDurationChanged();
     }
 }
@@ -722,12 +805,24 @@ void Button::setHorzPadding(qreal value)
 
 void Button::setIsLeftmost(bool isLeftmost)
 {
-    m_isLeftmost = isLeftmost;
+    if (m_isLeftmost != isLeftmost) {
+        m_isLeftmost = isLeftmost;
+        invalidateBackgroundCache();
+    }
 }
 
 void Button::setIsRightmost(bool isRightmost)
 {
-    m_isRightmost = isRightmost;
+    if (m_isRightmost != isRightmost) {
+        m_isRightmost = isRightmost;
+        invalidateBackgroundCache();
+    }
+}
+
+void Button::invalidateBackgroundCache()
+{
+    m_backgroundCache.radius = -1.0;
+    m_backgroundCache.path = QPainterPath();
 }
 
 /*
@@ -741,14 +836,7 @@ void Button::setVertPadding(int value)
 void Button::updateAnimationState(bool hovered)
 {
     if (m_animationEnabled) {
-        const QAbstractAnimation::Direction dir = hovered ? QAbstractAnimation::Forward : QAbstractAnimation::Backward;
-        if (m_animation->state() == QAbstractAnimation::Running && m_animation->direction() != dir) {
-            m_animation->stop();
-        }
-        m_animation->setDirection(dir);
-        if (m_animation->state() != QAbstractAnimation::Running) {
-            m_animation->start();
-        }
+        m_animation.start(hovered);
     } else {
         setTransitionValue(1);
     }
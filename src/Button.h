@@ -25,13 +25,15 @@
 // Qt
 #include <QMarginsF>
 #include <QMouseEvent>
+#include <QPainterPath>
+#include <QPixmap>
 #include <QRectF>
-#include <QVariantAnimation>
 #include <QTransform>
 
 class QTimer;
 class QPainter;
 
+#include "AnimationTicker.h"
 #include "PixelSnapper.h"
 
 namespace Material
@@ -98,6 +100,8 @@ signals:
 
 protected:
     virtual void paintIcon(QPainter *painter, const QRectF &iconRect, const PixelSnapper &snapper);
+    void paintGlyph(QPainter *painter, qreal iconLogicalSize);
+    QPixmap renderGlyph(qreal iconLogicalSize, qreal localToPhysicalScale, int physicalIconSize);
     virtual void updateSize(qreal contentWidth, qreal contentHeight);
     virtual void setHeight(qreal buttonHeight);
 
@@ -105,6 +109,7 @@ protected:
     virtual QColor foregroundColor() const;
 
     QRectF contentArea() const;
+    void invalidateBackgroundCache();
 
     qreal transitionValue() const;
     void setTransitionValue(qreal value);
@@ -116,7 +121,7 @@ protected:
     void onMaximizeHold();
 
     bool m_animationEnabled;
-    QVariantAnimation *m_animation;
+    Transition m_animation;
     qreal m_opacity;
     qreal m_transitionValue;
     QMarginsF m_padding;
@@ -124,6 +129,15 @@ protected:
     bool m_isLeftmost = false;
     bool m_isRightmost = false;
 
+    // Rounded background of the leftmost and rightmost buttons.
+    struct {
+        QRectF geometry;
+        qreal radius = -1.0;
+        bool roundLeft = false;
+        bool roundRight = false;
+        QPainterPath path;
+    } m_backgroundCache;
+
     QTimer *m_holdTimer = nullptr;
     bool m_longPressTriggered = false;
 
@@ -24,15 +24,23 @@
 
 // own
 #include "Decoration.h"
+#include "AnimationTicker.h"
 #include "AppMenuButtonGroup.h"
 #include "BoxShadowHelper.h"
 #include "BuildConfig.h"
 #include "Button.h"
+#include "GlyphCache.h"
 #include "TextButton.h"
 #include "InternalSettings.h"
+#include "SettingsDispatcher.h"
 #include "SettingsProvider.h"
 #include "Material.h"
+#include "PaintProfiler.h"
 #include "PixelSnapper.h"
+#include "ShadowCache.h"
+#include "ShadowDiskCache.h"
+#include "TextWidthCache.h"
+#include "Tracer.h"
 
 // KDecoration
 #include <KDecoration3/DecoratedWindow>
@@ -47,14 +55,18 @@
 
 // Qt
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtMath>
 #include <QHoverEvent>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
 #include <QRegion>
-#include <QSharedPointer>
+#include <QScopedValueRollback>
+#include <QStaticText>
 #include <QWheelEvent>
 #include <QTimer>
 #include <QDBusConnection>
@@ -165,16 +177,149 @@ void forEachButton(KDecoration3::DecorationButtonGroup *buttonGroup, Func f)
     }
 }
 
+QByteArray shadowDiskCacheId(const ShadowKey &key, const CompositeShadowParams &params, bool analytic)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << params.offset
+           << params.shadow1.offset << params.shadow1.radius << params.shadow1.opacity
+           << params.shadow2.offset << params.shadow2.radius << params.shadow2.opacity
+           << key.color << key.strength << key.cornerRadius
+           << analytic << ShadowDiskCache::s_generatorVersion;
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+// Runs on a worker thread, so it must not touch anything but its arguments.
+ShadowTexture createShadowTexture(const ShadowKey &key)
+{
+    CompositeShadowParams params = lookupShadowParams(key.sizePreset);
+    if (params.isNone()) {
+        return {};
+    }
+
+    const bool analytic = qEnvironmentVariableIsSet("MATERIAL_DECORATION_ANALYTIC_SHADOW");
+
+    const QByteArray diskCacheId = shadowDiskCacheId(key, params, analytic);
+    ShadowTexture cached = ShadowDiskCache::load(diskCacheId);
+    if (!cached.image.isNull()) {
+        return cached;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto withOpacity = [](const QColor &color, qreal opacity) -> QColor {
+        QColor c(color);
+        c.setAlphaF(opacity);
+        return c;
+    };
+
+    const QSize boxSize =
+        BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius).expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
+
+    BoxShadowRenderer shadowRenderer;
+    shadowRenderer.setBorderRadius(key.cornerRadius + 0.5);
+    shadowRenderer.setBoxSize(boxSize);
+    if (analytic) {
+        shadowRenderer.setAlgorithm(BoxShadowRenderer::Algorithm::Analytic);
+    }
+
+    const QColor shadowColor = QColor::fromRgba(key.color);
+    const qreal strength = key.strength / 255.0;
+    shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius, withOpacity(shadowColor, params.shadow1.opacity * strength));
+    shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius, withOpacity(shadowColor, params.shadow2.opacity * strength));
+
+    QImage shadowTexture = shadowRenderer.render();
+
+    QPainter painter(&shadowTexture);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const QRectF outerRect = shadowTexture.rect();
+
+    QRectF boxRect(QPoint(0, 0), boxSize);
+    boxRect.moveCenter(outerRect.center());
+
+    // Mask out inner rect.
+    const QMarginsF padding = QMarginsF(boxRect.left() - outerRect.left() - params.offset.x(),
+                                        boxRect.top() - outerRect.top() - params.offset.y(),
+                                        outerRect.right() - boxRect.right() + params.offset.x(),
+                                        outerRect.bottom() - boxRect.bottom() + params.offset.y());
+    QRectF innerRect = outerRect - padding;
+    // Push the shadow slightly under the window, which helps avoiding glitches with fractional scaling
+    //innerRect.adjust(2, 2, -2, -2);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+    painter.drawRoundedRect(innerRect, key.cornerRadius + 0.5, key.cornerRadius + 0.5);
+
+    painter.end();
+
+    qCDebug(category) << "Shadow texture: preset" << key.sizePreset
+                      << "size" << shadowTexture.size()
+                      << "bytes" << shadowTexture.sizeInBytes()
+                      << "took" << timer.nsecsElapsed() / 1000 << "us";
+
+    ShadowTexture ret;
+    ret.image = shadowTexture;
+    ret.padding = padding;
+    ret.innerShadowRect = QRectF(outerRect.center(), QSizeF(1, 1));
+    ShadowDiskCache::store(diskCacheId, ret);
+    return ret;
+}
+
+// Shared by all decorations, to spot layout storms.
+void countLayout()
+{
+    if (!category.isDebugEnabled()) {
+        return;
+    }
+
+    static QElapsedTimer s_clock;
+    static int s_layouts = 0;
+    if (!s_clock.isValid()) {
+        s_clock.start();
+    }
+    ++s_layouts;
+    if (s_clock.elapsed() >= 1000) {
+        qCDebug(category) << "Button layouts per second:" << s_layouts * 1000.0 / s_clock.elapsed();
+        s_layouts = 0;
+        s_clock.restart();
+    }
+}
+
+/**
+ * Tint every repainted area with a translucent color that changes from one
+ * frame to the next, and log its size. Enabled by setting
+ * MATERIAL_DECORATION_SHOW_REPAINTS in the environment.
+ **/
+void showRepaint(QPainter *painter, const QRectF &repaintRegion, const QRectF &decorationRect)
+{
+    static const bool enabled = qEnvironmentVariableIsSet("MATERIAL_DECORATION_SHOW_REPAINTS");
+    if (!enabled) {
+        return;
+    }
+
+    static int s_frame = 0;
+    const QRectF area = repaintRegion.intersected(decorationRect);
+    painter->save();
+    painter->fillRect(area, QColor::fromHsv((s_frame++ * 47) % 360, 255, 255, 64));
+    painter->restore();
+
+    qCDebug(category) << "Repaint" << area
+                      << "|" << qRound(100.0 * area.width() * area.height()
+                                       / qMax(1.0, decorationRect.width() * decorationRect.height()))
+                      << "% of the decoration";
+}
+
+// How long the menu bar outlives the application menu, so that a menu
+// that is re-registered right away does not rebuild everything.
+constexpr int s_menuTeardownDelay = 1000;
+
 } // anonymous namespace
 
 static std::atomic<int> s_decoCount(0);
 
-static int s_shadowSizePreset = InternalSettings::ShadowVeryLarge;
-static int s_shadowStrength = 255;
-static QColor s_shadowColor = QColor(33, 33, 33);
-static qreal s_cornerRadius = -1;
-static std::shared_ptr<KDecoration3::DecorationShadow> s_cachedShadow;
-
 Decoration::Decoration(QObject *parent, const QVariantList &args)
     : KDecoration3::Decoration(parent, args)
     , m_internalSettings(nullptr)
@@ -184,17 +329,16 @@ Decoration::Decoration(QObject *parent, const QVariantList &args)
 
 Decoration::~Decoration()
 {
+    SettingsDispatcher::self()->remove(this);
+
     int count = --s_decoCount;
     if (count <= 0) {
         Q_ASSERT_X(count >= 0, "Decoration::~Decoration()", "s_decoCount became negative, indicating a logic error!");
         if (count < 0) {
             s_decoCount.store(0); // defensive reset
         }
-        s_cachedShadow.reset();
-        s_shadowSizePreset = -1;
-        s_shadowStrength = -1;
-        s_shadowColor = QColor();
-        s_cornerRadius = -1;
+        ShadowCache::self()->clear();
+        GlyphCache::self()->clear();
     }
 
     delete m_leftButtons;
@@ -213,13 +357,60 @@ void Decoration::setupMenu()
 
     m_menuButtons = new AppMenuButtonGroup(this);
     connect(m_menuButtons, &AppMenuButtonGroup::menuUpdated,
-            this, &Decoration::updateButtonsGeometry);
+            this, &Decoration::updateButtonsGeometryDelayed);
+    // The menu buttons repaint themselves, only the caption fading in the
+    // opposite direction is left.
     connect(m_menuButtons, &AppMenuButtonGroup::opacityChanged,
-            this, repaintTitleBar);
+            this, [this] {
+                const QRectF captionRect = m_captionRect.isValid() ? m_captionRect : centerRect();
+                AnimationTicker::self()->update(this, m_menuButtons->geometry().united(captionRect));
+            });
     connect(m_menuButtons, &AppMenuButtonGroup::alwaysShowChanged,
             this, repaintTitleBar);
     m_menuButtons->updateAppMenuModel();
-    m_menuButtons->setHamburgerMenu(m_internalSettings->hamburgerMenu());
+    // The group can be created long after init(), so bring it up to the
+    // current settings here rather than waiting for the next change.
+    m_menuButtons->setHamburgerMenu(m_internalSettings->hamburgerMenu);
+    m_menuButtons->setAlwaysShow(menuAlwaysShow());
+    updateButtonAnimation();
+}
+
+void Decoration::updateMenuPresence()
+{
+    // Same conditions under which updateAppMenuModel() shows anything.
+    const auto *decoratedClient = window();
+    const bool wanted = decoratedClient->hasApplicationMenu() && !decoratedClient->isModal();
+
+    if (wanted) {
+        m_menuTeardownTimer->stop();
+    }
+
+    if (wanted && !m_menuButtons) {
+        const qsizetype before = findChildren<QObject *>().size();
+        setupMenu();
+        qCDebug(category) << "App menu created for" << decoratedClient->caption()
+                          << "| QObjects" << before << "->" << findChildren<QObject *>().size();
+        updateButtonsGeometryDelayed();
+    } else if (!wanted && m_menuButtons && !m_menuTeardownTimer->isActive()) {
+        m_menuTeardownTimer->start();
+    }
+}
+
+void Decoration::teardownMenu()
+{
+    const auto *decoratedClient = window();
+    if (!m_menuButtons || (decoratedClient->hasApplicationMenu() && !decoratedClient->isModal())) {
+        return;
+    }
+
+    const qsizetype before = findChildren<QObject *>().size();
+    delete m_menuButtons;
+    m_menuButtons = nullptr;
+    qCDebug(category) << "App menu destroyed for" << decoratedClient->caption()
+                      << "| QObjects" << before << "->" << findChildren<QObject *>().size();
+
+    invalidateCaptionCache();
+    updateButtonsGeometryDelayed();
 }
 
 QRectF Decoration::titleBarRect() const
@@ -246,20 +437,27 @@ QRectF Decoration::centerRect() const
 
 void Decoration::paint(QPainter *painter, const QRectF &repaintRegion)
 {
+    const ProfileScope scope(PaintProfiler::Paint);
+
     auto *decoratedClient = window();
 
-    if (!decoratedClient->isShaded()) {
-        paintFrameBackground(painter, repaintRegion);
+    if (!paintCachedBackground(painter, repaintRegion)) {
+        if (!decoratedClient->isShaded()) {
+            paintFrameBackground(painter, repaintRegion);
+        }
+        paintTitleBarBackground(painter, repaintRegion);
     }
-    paintTitleBarBackground(painter, repaintRegion);
     paintButtons(painter, repaintRegion);
     paintCaption(painter, repaintRegion);
+
+    showRepaint(painter, repaintRegion, rect());
 }
 
 bool Decoration::init()
 {    
-    setInternalSettings(SettingsProvider::self()->internalSettings(this));
-    connect(SettingsProvider::self(), &SettingsProvider::configChanged, this, &Decoration::reconfigure);
+    const TraceScope trace("Decoration::init");
+    setInternalSettings(SettingsProvider::self()->internalSettings(this, m_settingsResolution));
+    connect(ShadowCache::self(), &ShadowCache::shadowReady, this, &Decoration::onShadowReady);
 
     const auto *decoratedClient = window();
 
@@ -273,7 +471,14 @@ bool Decoration::init()
         this,
         &Button::create);
 
-    setupMenu();
+    m_menuTeardownTimer = new QTimer(this);
+    m_menuTeardownTimer->setSingleShot(true);
+    m_menuTeardownTimer->setInterval(s_menuTeardownDelay);
+    connect(m_menuTeardownTimer, &QTimer::timeout, this, &Decoration::teardownMenu);
+
+    updateMenuPresence();
+    connect(decoratedClient, &KDecoration3::DecoratedWindow::hasApplicationMenuChanged,
+            this, &Decoration::updateMenuPresence);
 
     connect(decoratedClient, &KDecoration3::DecoratedWindow::sizeChanged,
             this, &Decoration::onSizeChanged);
@@ -297,10 +502,11 @@ bool Decoration::init()
 
     connect(decoratedClient, &KDecoration3::DecoratedWindow::captionChanged,
             this, [this] {
-                auto newSettings = SettingsProvider::self()->internalSettings(this);
-                if (newSettings != m_internalSettings) {
-                    setInternalSettings(newSettings);
-                    applySettings();
+                auto newSettings = SettingsProvider::self()->internalSettings(this, m_settingsResolution);
+                const int changes = diffResolvedSettings(m_internalSettings, newSettings);
+                setInternalSettings(newSettings);
+                if (changes) {
+                    applySettings(changes);
                 } else {
                     invalidateCaptionCache();
                     update(titleBar());
@@ -310,6 +516,13 @@ bool Decoration::init()
     connect(decoratedClient, &KDecoration3::DecoratedWindow::activeChanged,
         this, &Decoration::onActiveChanged);
 
+    // A color scheme change reaches us through the window palette, our
+    // configuration file stays the same.
+    connect(decoratedClient, &KDecoration3::DecoratedWindow::paletteChanged,
+            this, [this] {
+                applySettings(SettingsChange::Colors);
+            });
+
     connect(decoratedClient, &KDecoration3::DecoratedWindow::adjacentScreenEdgesChanged,
             this, &Decoration::onAdjacentScreenEdgesChanged);
     
@@ -354,24 +567,10 @@ bool Decoration::init()
     }
 #endif
 
-    // Window Decoration KCM
-    // The reconfigure signal will update active windows, but we need to hook
-    // individual signals for the preview in the KCM.
-    connect(settings().get(), &KDecoration3::DecorationSettings::reconfigured,
-        SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection);
-    connect(settings().get(), &KDecoration3::DecorationSettings::alphaChannelSupportedChanged,
-        this, &Decoration::reconfigure);
-    connect(settings().get(), &KDecoration3::DecorationSettings::borderSizeChanged, 
-        this, &Decoration::updateBordersCornersBlurShadow);
-    connect(settings().get(), &KDecoration3::DecorationSettings::fontChanged,
-        this, &Decoration::updateBordersCornersBlurShadow);
-    connect(settings().get(), &KDecoration3::DecorationSettings::spacingChanged,
-        this, &Decoration::onSpacingChanged);
-    connect(settings().get(), &KDecoration3::DecorationSettings::decorationButtonsLeftChanged,
-        this, &Decoration::updateButtonsGeometryDelayed);
-    connect(settings().get(), &KDecoration3::DecorationSettings::decorationButtonsRightChanged,
-        this, &Decoration::updateButtonsGeometryDelayed);
-    
+    // Our configuration and the window manager's decoration settings
+    // reach every decoration through one batched update.
+    SettingsDispatcher::self()->add(this);
+
     applySettings();
 
     return true;
@@ -379,49 +578,76 @@ bool Decoration::init()
 
 bool Decoration::hideTitleBar() const
 {
-    return m_internalSettings ? m_internalSettings->hideTitleBar() : false;
+    return m_internalSettings ? m_internalSettings->hideTitleBar : false;
 }
 
-void Decoration::setInternalSettings(const QSharedPointer<InternalSettings> &settings)
+void Decoration::setInternalSettings(const ResolvedSettingsPtr &settings)
 {
-    if (m_internalSettings == settings) {
-        return;
-    }
     m_internalSettings = settings;
-    if (m_internalSettings) {
-        connect(m_internalSettings.data(), &InternalSettings::configChanged, this, &Decoration::reconfigure, Qt::UniqueConnection);
-    }
 }
 
-void Decoration::applySettings()
+void Decoration::applySettings(int changes)
 {
+    const TraceScope trace("Decoration::applySettings");
+
     if (!m_internalSettings) {
         return;
     }
-    m_bottomCornersFlag = m_internalSettings->bottomCornerRadiusFlag();
+    m_bottomCornersFlag = m_internalSettings->bottomCornerRadiusFlag;
 
-    if (m_menuButtons) {
-        m_menuButtons->setHamburgerMenu(m_internalSettings->hamburgerMenu());
+    if (m_menuButtons && (changes & SettingsChange::Menu)) {
+        m_menuButtons->setHamburgerMenu(m_internalSettings->hamburgerMenu);
         m_menuButtons->updateAppMenuModel();
         m_menuButtons->setAlwaysShow(menuAlwaysShow());
     }
 
-    invalidateCaptionCache();
-    updateColors();
-    updateButtonAnimation();
-    updateBordersCornersBlurShadow();
-    updateResizeBorders();
-    updateTitleBar();
-    updateButtonsGeometryDelayed();
-    updateTitleBarHoverState();
-    update();
+    if (changes & (SettingsChange::Caption | SettingsChange::Menu)) {
+        invalidateCaptionCache();
+    }
+    if (changes & SettingsChange::Colors) {
+        updateColors();
+    }
+    if (changes & SettingsChange::Animation) {
+        updateButtonAnimation();
+    }
+
+    if (changes & SettingsChange::Frame) {
+        updateBordersCornersBlurShadow();
+        updateResizeBorders();
+        updateTitleBar();
+    } else {
+        if (changes & SettingsChange::Colors) {
+            // The outline takes the border color.
+            updateCornerRadiusAndOutline();
+        }
+        if (changes & SettingsChange::Shadow) {
+            updateShadow();
+        }
+    }
+
+    if (changes & (SettingsChange::Frame | SettingsChange::Caption | SettingsChange::Menu | SettingsChange::ButtonLayout)) {
+        updateButtonsGeometryDelayed();
+        updateTitleBarHoverState();
+    }
+
+    if (changes & (SettingsChange::Frame | SettingsChange::Colors)) {
+        update();
+    } else if (changes & (SettingsChange::Caption | SettingsChange::Menu)) {
+        update(titleBar());
+    }
 }
 
-void Decoration::reconfigure()
+void Decoration::onSettingsChanged(int changes)
 {
-    resetDragMove();
-    setInternalSettings(SettingsProvider::self()->internalSettings(this));
-    applySettings();
+    const ResolvedSettingsPtr previous = m_internalSettings;
+    setInternalSettings(SettingsProvider::self()->internalSettings(this, m_settingsResolution));
+
+    changes |= diffResolvedSettings(previous, m_internalSettings);
+    qCDebug(category) << "Settings changed for" << window()->caption() << "| mask" << Qt::hex << changes;
+    if (changes) {
+        resetDragMove();
+        applySettings(changes);
+    }
 }
 
 void Decoration::mousePressEvent(QMouseEvent *event)
@@ -556,6 +782,12 @@ void Decoration::updateTitleBar()
 {
     setTitleBar(titleBarRect());
     invalidateCaptionCache();
+
+    // The buttons follow the title bar. Lay them out now instead of
+    // letting the next frame paint them at their old positions.
+    if (m_layoutPending && !m_inLayout) {
+        updateButtonsGeometry();
+    }
 }
 
 void Decoration::updateTitleBarHoverState()
@@ -613,12 +845,20 @@ void Decoration::updateButtonHeight()
 
 void Decoration::invalidateCaptionCache() const
 {
-    m_captionCache.availableWidth = -1.0;
+    // Prepared captions are keyed on their width, so geometry changes don't affect them.
     m_captionCache.textWidth = -1.0;
 }
 
 void Decoration::updateButtonsGeometry()
 {
+    const ProfileScope scope(PaintProfiler::ButtonsGeometry);
+    const TraceScope trace("Decoration::updateButtonsGeometry");
+
+    m_layoutPending = false;
+    // Button geometry changes caused by this very pass don't need another one.
+    const QScopedValueRollback<bool> inLayout(m_inLayout, true);
+    countLayout();
+
     invalidateCaptionCache();
     if (m_menuButtons) {
         m_menuButtons->updateShowing();
@@ -653,7 +893,7 @@ void Decoration::updateButtonsGeometry()
         }
         availableRect.translate(0, top);
 
-        setButtonGroupHorzPadding(m_menuButtons, m_internalSettings->menuButtonHorzPadding());
+        setButtonGroupHorzPadding(m_menuButtons, m_internalSettings->menuButtonHorzPadding);
         
         m_menuButtons->updateOverflow(availableRect);
 
@@ -705,12 +945,24 @@ void Decoration::updateButtonsGeometry()
 
     updatePaths();
     updateBlur();
-    update();
+    // Buttons and caption only move within the title bar. Border and size
+    // changes are repainted in full by KWin anyway.
+    update(titleBar());
 }
 
 void Decoration::updateButtonsGeometryDelayed()
 {
-    QTimer::singleShot(0, this, &Decoration::updateButtonsGeometry);
+    // However many times the layout is invalidated, it runs once, on the
+    // next event loop iteration.
+    if (m_layoutPending || m_inLayout) {
+        return;
+    }
+    m_layoutPending = true;
+    QTimer::singleShot(0, this, [this] {
+        if (m_layoutPending) {
+            updateButtonsGeometry();
+        }
+    });
 }
 
 void Decoration::setButtonGroupAnimation(KDecoration3::DecorationButtonGroup *buttonGroup, bool enabled, int duration)
@@ -738,89 +990,45 @@ void Decoration::updateButtonAnimation()
 
 void Decoration::updateShadow()
 {
-    if (!m_internalSettings || m_internalSettings->hideShadow()) {
+    const ProfileScope scope(PaintProfiler::UpdateShadow);
+    const TraceScope trace("Decoration::updateShadow");
+
+    m_pendingShadowKey.reset();
+
+    if (!m_internalSettings || m_internalSettings->hideShadow
+        || lookupShadowParams(m_internalSettings->shadowSize).isNone()) {
         setShadow(nullptr);
         return;
     }
 
-    const QColor shadowColor = m_internalSettings->shadowColor();
-    const int shadowStrengthInt = m_internalSettings->shadowStrength();
-    const int shadowSizePreset = m_internalSettings->shadowSize();
+    ShadowKey key;
+    key.sizePreset = m_internalSettings->shadowSize;
+    key.color = m_internalSettings->shadowColor;
+    key.strength = m_internalSettings->shadowStrength;
+    key.cornerRadius = m_cornerRadius;
 
-    if (s_cachedShadow
-        && s_shadowColor == shadowColor
-        && s_shadowSizePreset == shadowSizePreset
-        && s_shadowStrength == shadowStrengthInt
-        && s_cornerRadius == m_cornerRadius
-    ) {
-        setShadow(s_cachedShadow);
+    ShadowCache *cache = ShadowCache::self();
+    if (auto shadow = cache->find(key)) {
+        setShadow(shadow);
         return;
     }
 
-    s_shadowColor = shadowColor;
-    s_shadowStrength = shadowStrengthInt;
-    s_shadowSizePreset = shadowSizePreset;
-    s_cornerRadius = m_cornerRadius;
-
-    s_cachedShadow = createShadowObject(1.0);
-    setShadow(s_cachedShadow);
+    // Show whatever comes closest until the real one is ready, and keep
+    // the current shadow if there is nothing better.
+    if (auto placeholder = cache->nearest(key)) {
+        setShadow(placeholder);
+    }
+    m_pendingShadowKey = key;
+    cache->request(key, &createShadowTexture);
 }
 
-std::shared_ptr<KDecoration3::DecorationShadow> Decoration::createShadowObject(const float strengthScale)
+void Decoration::onShadowReady(const ShadowKey &key)
 {
-    CompositeShadowParams params = lookupShadowParams(m_internalSettings->shadowSize());
-    if (params.isNone()) {
-        return nullptr;
+    if (m_pendingShadowKey != key) {
+        return;
     }
-
-    auto withOpacity = [](const QColor &color, qreal opacity) -> QColor {
-        QColor c(color);
-        c.setAlphaF(opacity);
-        return c;
-    };
-
-    const QSize boxSize =
-        BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius).expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius));
-
-    BoxShadowRenderer shadowRenderer;
-    shadowRenderer.setBorderRadius(m_cornerRadius + 0.5);
-    shadowRenderer.setBoxSize(boxSize);
-
-    const qreal strength = m_internalSettings->shadowStrength() / 255.0 * strengthScale;
-    shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius, withOpacity(m_internalSettings->shadowColor(), params.shadow1.opacity * strength));
-    shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius, withOpacity(m_internalSettings->shadowColor(), params.shadow2.opacity * strength));
-
-    QImage shadowTexture = shadowRenderer.render();
-
-    QPainter painter(&shadowTexture);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    const QRectF outerRect = shadowTexture.rect();
-
-    QRectF boxRect(QPoint(0, 0), boxSize);
-    boxRect.moveCenter(outerRect.center());
-
-    // Mask out inner rect.
-    const QMarginsF padding = QMarginsF(boxRect.left() - outerRect.left() - params.offset.x(),
-                                        boxRect.top() - outerRect.top() - params.offset.y(),
-                                        outerRect.right() - boxRect.right() + params.offset.x(),
-                                        outerRect.bottom() - boxRect.bottom() + params.offset.y());
-    QRectF innerRect = outerRect - padding;
-    // Push the shadow slightly under the window, which helps avoiding glitches with fractional scaling
-    //innerRect.adjust(2, 2, -2, -2);
-
-    painter.setPen(Qt::NoPen);
-    painter.setBrush(Qt::black);
-    painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
-    painter.drawRoundedRect(innerRect, m_cornerRadius + 0.5, m_cornerRadius + 0.5);
-
-    painter.end();
-
-    auto ret = std::make_shared<KDecoration3::DecorationShadow>();
-    ret->setPadding(padding);
-    ret->setInnerShadowRect(QRectF(outerRect.center(), QSizeF(1, 1)));
-    ret->setShadow(shadowTexture);
-    return ret;
+    m_pendingShadowKey.reset();
+    setShadow(ShadowCache::self()->find(key));
 }
 
 bool Decoration::menuAlwaysShow() const
@@ -828,76 +1036,76 @@ bool Decoration::menuAlwaysShow() const
     if (!m_internalSettings) {
         return true;
     }
-    if (m_internalSettings->hideApplicationMenu()) {
+    if (m_internalSettings->hideApplicationMenu) {
         return false;
     }
-    return m_internalSettings->menuAlwaysShow();
+    return m_internalSettings->menuAlwaysShow;
 }
 
 bool Decoration::useSystemMenuFont() const
 {
-    return m_internalSettings ? m_internalSettings->useSystemMenuFont() : false;
+    return m_internalSettings ? m_internalSettings->useSystemMenuFont : false;
 }
 
 bool Decoration::hamburgerMenu() const
 {
-    return m_internalSettings ? m_internalSettings->hamburgerMenu() : false;
+    return m_internalSettings ? m_internalSettings->hamburgerMenu : false;
 }
 
 bool Decoration::searchEnabled() const
 {
-    return m_internalSettings ? m_internalSettings->searchEnabled() : true;
+    return m_internalSettings ? m_internalSettings->searchEnabled : true;
 }
 
 bool Decoration::showDisabledActions() const
 {
-    return m_internalSettings ? m_internalSettings->showDisabledActions() : false;
+    return m_internalSettings ? m_internalSettings->showDisabledActions : false;
 }
 
 bool Decoration::searchIgnoreTopLevel() const
 {
-    return m_internalSettings ? m_internalSettings->searchIgnoreTopLevel() : true;
+    return m_internalSettings ? m_internalSettings->searchIgnoreTopLevel : true;
 }
 
 bool Decoration::searchIgnoreSubMenus() const
 {
-    return m_internalSettings ? m_internalSettings->searchIgnoreSubMenus() : false;
+    return m_internalSettings ? m_internalSettings->searchIgnoreSubMenus : false;
 }
 
 bool Decoration::searchFuzzyMatching() const
 {
-    return m_internalSettings ? m_internalSettings->searchFuzzyMatching() : false;
+    return m_internalSettings ? m_internalSettings->searchFuzzyMatching : false;
 }
 
 bool Decoration::animationsEnabled() const
 {
-    return m_internalSettings ? m_internalSettings->animationsEnabled() : true;
+    return m_internalSettings ? m_internalSettings->animationsEnabled : true;
 }
 
 int Decoration::animationsDuration() const
 {
-    return m_internalSettings ? m_internalSettings->animationsDuration() : 250;
+    return m_internalSettings ? m_internalSettings->animationsDuration : 250;
 }
 
 bool Decoration::dragFromButtonsEnabled() const
 {
-    return m_internalSettings ? m_internalSettings->dragFromButtonsEnabled() : true;
+    return m_internalSettings ? m_internalSettings->dragFromButtonsEnabled : true;
 }
 
 bool Decoration::hideCaptionWhenLimitedSpace() const
 {
-    return m_internalSettings ? m_internalSettings->hideCaptionWhenLimitedSpace() : true;
+    return m_internalSettings ? m_internalSettings->hideCaptionWhenLimitedSpace : true;
 }
 
 bool Decoration::showCaptionOnHover() const
 {
-    return m_internalSettings ? m_internalSettings->showCaptionOnHover() : false;
+    return m_internalSettings ? m_internalSettings->showCaptionOnHover : false;
 }
 
 qreal Decoration::buttonPadding() const
 {
     const qreal baseUnit = m_tabletMode ? settings()->gridUnit() * 2 : settings()->gridUnit();
-    switch (m_internalSettings->buttonSize()) {
+    switch (m_internalSettings->buttonSize) {
     case InternalSettings::ButtonTiny:
         return baseUnit * 0.2;
     case InternalSettings::ButtonSmall:
@@ -1007,12 +1215,7 @@ QFont Decoration::menuFont() const
 
 qreal Decoration::getMenuTextWidth(const QString &text, bool showMnemonic) const
 {
-    const QFontMetricsF fontMetrics(menuFont());
-    const int flags = showMnemonic ? Qt::TextShowMnemonic : Qt::TextHideMnemonic;
-    // Use an unconstrained bounding rect to get the ideal width.
-    const QRectF boundingRect = fontMetrics.boundingRect(QRectF(), flags, text);
-    const qreal scale = window()->nextScale();
-    return qCeil(boundingRect.width() * scale) / scale;
+    return TextWidthCache::self()->width(menuFont(), text, showMnemonic, window()->nextScale());
 }
 
 bool Decoration::isMenuOnRight() const
@@ -1142,6 +1345,8 @@ QPainterPath Decoration::getRoundedPath(const QRectF &rect,
 
 void Decoration::paintFrameBackground(QPainter *painter, const QRectF &repaintRegion) const
 {
+    const ProfileScope scope(PaintProfiler::FrameBackground);
+
     if (!rect().intersects(repaintRegion)) {
         return;
     }
@@ -1151,10 +1356,18 @@ void Decoration::paintFrameBackground(QPainter *painter, const QRectF &repaintRe
     painter->fillRect(rect(), Qt::transparent); 
     
     if (!hasNoBorders()) {
-        painter->setRenderHint(QPainter::Antialiasing);
-        painter->setPen(Qt::NoPen);        
-        painter->setBrush(borderColor());        
-        painter->drawPath(m_framePath.subtracted(m_titleBarPath));
+        if (m_squareCorners) {
+            const QColor color = borderColor();
+            painter->setRenderHint(QPainter::Antialiasing, false);
+            for (const QRectF &borderRect : std::as_const(m_borderRects)) {
+                painter->fillRect(borderRect, color);
+            }
+        } else {
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(borderColor());
+            painter->drawPath(m_borderPath);
+        }
     }
     
     painter->restore();
@@ -1170,14 +1383,14 @@ QColor Decoration::borderColor() const
     const auto *decoratedClient = window();
     const bool isActive = decoratedClient->isActive();
     const qreal opacity = isActive
-        ? m_internalSettings->activeOpacity()
-        : m_internalSettings->inactiveOpacity();
+        ? m_internalSettings->activeOpacity
+        : m_internalSettings->inactiveOpacity;
     
     QColor color;
-    if (m_internalSettings->useCustomBorderColors()) {
-        color = isActive
-            ? m_internalSettings->activeBorderColor()
-            : m_internalSettings->inactiveBorderColor();
+    if (m_internalSettings->useCustomBorderColors) {
+        color = QColor::fromRgba(isActive
+            ? m_internalSettings->activeBorderColor
+            : m_internalSettings->inactiveBorderColor);
     } else {
         const auto group = isActive
             ? KDecoration3::ColorGroup::Active
@@ -1196,8 +1409,8 @@ void Decoration::updateColors()
         ? KDecoration3::ColorGroup::Active
         : KDecoration3::ColorGroup::Inactive;
     const qreal opacity = decoratedClient->isActive()
-        ? m_internalSettings->activeOpacity()
-        : m_internalSettings->inactiveOpacity();
+        ? m_internalSettings->activeOpacity
+        : m_internalSettings->inactiveOpacity;
 
     m_titleBarOpaqueBackgroundColor = decoratedClient->color(group, KDecoration3::ColorRole::TitleBar);
     m_titleBarBackgroundColor = m_titleBarOpaqueBackgroundColor;
@@ -1207,29 +1420,129 @@ void Decoration::updateColors()
 
 void Decoration::paintTitleBarBackground(QPainter *painter, const QRectF &repaintRegion) const
 {
-    if (hideTitleBar() || !m_titleBarPath.boundingRect().intersects(repaintRegion)) {
+    const ProfileScope scope(PaintProfiler::TitleBarBackground);
+
+    if (hideTitleBar() || !m_titleBarRect.intersects(repaintRegion)) {
         return;
     }
 
     painter->save();
-    painter->setRenderHint(QPainter::Antialiasing);
-    painter->setPen(Qt::NoPen);
-    painter->setBrush(titleBarBackgroundColor());
+    if (m_squareCorners) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->fillRect(m_titleBarRect, titleBarBackgroundColor());
+    } else {
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(titleBarBackgroundColor());
+        painter->drawPath(m_titleBarPath);
+    }
+    painter->restore();
+}
 
-    painter->drawPath(m_titleBarPath);
+bool Decoration::paintCachedBackground(QPainter *painter, const QRectF &repaintRegion) const
+{
+    // Opt-in: each decoration keeps up to four full-width ARGB strips
+    // (top and bottom, active and inactive), around 200 KiB for a 1920
+    // pixel wide window at scale 1. That pays off in software-rendered
+    // sessions, less so when painting is cheap. Square corners are already
+    // drawn with plain, unantialiased fills.
+    static const bool enabled = qEnvironmentVariableIsSet("MATERIAL_DECORATION_BACKGROUND_CACHE");
+    if (!enabled || m_squareCorners || window()->isShaded()) {
+        return false;
+    }
 
-    painter->restore();
+    // Stands in for both background stages.
+    const ProfileScope scope(PaintProfiler::FrameBackground);
+
+    const QRectF frame = rect();
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const QColor titleBarColor = hideTitleBar() ? QColor() : titleBarBackgroundColor();
+    const QColor frameColor = hasNoBorders() ? QColor() : borderColor();
+
+    BackgroundCache &cache = m_backgroundCache[window()->isActive()];
+    if (cache.pathsSerial != m_pathsSerial
+        || cache.devicePixelRatio != dpr
+        || cache.titleBarColor != titleBarColor
+        || cache.borderColor != frameColor) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // Keep the strip edges on device pixels so that the blits line up
+        // with the side borders without seams.
+        const qreal topEdge = hideTitleBar() ? topOffset() + m_cornerRadius : m_titleBarRect.bottom() - frame.top();
+        cache.topHeight = std::min(qCeil(topEdge * dpr) / dpr, frame.height());
+        cache.bottomTop = std::max(qFloor((frame.height() - bottomOffset() - m_cornerRadius) * dpr) / dpr, cache.topHeight);
+
+        auto renderStrip = [&](qreal y, qreal height) {
+            QImage image(QSize(qCeil(frame.width() * dpr), qRound(height * dpr)), QImage::Format_ARGB32_Premultiplied);
+            image.setDevicePixelRatio(dpr);
+            image.fill(Qt::transparent);
+
+            QPainter p(&image);
+            p.setRenderHint(QPainter::Antialiasing);
+            p.setPen(Qt::NoPen);
+            p.translate(-frame.left(), -frame.top() - y);
+            if (frameColor.isValid()) {
+                p.setBrush(frameColor);
+                p.drawPath(m_borderPath);
+            }
+            if (titleBarColor.isValid()) {
+                p.setBrush(titleBarColor);
+                p.drawPath(m_titleBarPath);
+            }
+            return image;
+        };
+        cache.top = renderStrip(0, cache.topHeight);
+        cache.bottom = renderStrip(cache.bottomTop, frame.height() - cache.bottomTop);
+
+        cache.pathsSerial = m_pathsSerial;
+        cache.devicePixelRatio = dpr;
+        cache.titleBarColor = titleBarColor;
+        cache.borderColor = frameColor;
+
+        qCDebug(category) << "Background cache:" << (window()->isActive() ? "active" : "inactive")
+                          << cache.top.size() << cache.bottom.size()
+                          << "rendered in" << timer.nsecsElapsed() / 1000 << "µs";
+    }
+
+    // Only the part that is being repainted, in whole device pixels.
+    auto blit = [&](const QImage &image, const QPointF &origin) {
+        const QRectF target = QRectF(origin, image.deviceIndependentSize()).intersected(repaintRegion);
+        if (target.isEmpty()) {
+            return;
+        }
+        const QRect source = QRectF((target.topLeft() - origin) * dpr, target.size() * dpr).toAlignedRect().intersected(image.rect());
+        painter->drawImage(QRectF(origin + QPointF(source.topLeft()) / dpr, QSizeF(source.size()) / dpr), image, source);
+    };
+
+    blit(cache.top, frame.topLeft());
+    blit(cache.bottom, frame.topLeft() + QPointF(0, cache.bottomTop));
+
+    if (frameColor.isValid() && cache.bottomTop > cache.topHeight) {
+        const qreal height = cache.bottomTop - cache.topHeight;
+        const qreal y = frame.top() + cache.topHeight;
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->fillRect(QRectF(frame.left(), y, leftOffset(), height).intersected(repaintRegion), frameColor);
+        painter->fillRect(QRectF(frame.right() - rightOffset(), y, rightOffset(), height).intersected(repaintRegion), frameColor);
+        painter->restore();
+    }
+
+    return true;
 }
 
 void Decoration::paintCaption(QPainter *painter, const QRectF &repaintRegion) const
 {
+    const ProfileScope scope(PaintProfiler::Caption);
+
     // 1. Pre-checks and data gathering
     const auto *decoratedClient = window();
-    const bool appMenuVisible = !m_menuButtons->buttons().isEmpty();
-    const bool isWaitingForMenu = m_menuButtons->isWaitingForMenu();
-    const bool menuLoadedOnce = m_menuButtons->menuLoadedOnce();
+    // Without a menu group there is no menu to wait for.
+    const bool appMenuVisible = m_menuButtons && !m_menuButtons->buttons().isEmpty();
+    const bool isWaitingForMenu = m_menuButtons && m_menuButtons->isWaitingForMenu();
+    const bool menuLoadedOnce = !m_menuButtons || m_menuButtons->menuLoadedOnce();
     const bool hasAppMenu = decoratedClient->hasApplicationMenu();
-    const bool isTitleHidden = m_internalSettings->titleAlignment() == InternalSettings::TitleHidden;
+    const bool isTitleHidden = m_internalSettings->titleAlignment == InternalSettings::TitleHidden;
 
     if (hideTitleBar() || isTitleHidden || (!menuLoadedOnce && (isWaitingForMenu || hasAppMenu))) {
         m_captionLimited = false;
@@ -1268,17 +1581,16 @@ void Decoration::paintCaption(QPainter *painter, const QRectF &repaintRegion) co
         m_captionCache.fullCaption = fullCaption;
         m_captionCache.font = font;
         m_captionCache.textWidth = getFontMetrics().boundingRect(fullCaption).width();
-        m_captionCache.availableWidth = -1.0;
     }
     const qreal textWidth = m_captionCache.textWidth;
-    const bool spaceLimited = appMenuVisible && hideCaptionWhenLimitedSpace() && constrainedRect.width() < m_internalSettings->minWidthForCaption();
+    const bool spaceLimited = appMenuVisible && hideCaptionWhenLimitedSpace() && constrainedRect.width() < m_internalSettings->minWidthForCaption;
     const bool textElided = textWidth > constrainedRect.width();
 
     m_captionLimited = spaceLimited || textElided;
     m_captionRect = constrainedRect.translated(0, offset);
 
     // 4. Reveal logic (show caption on hover if limited)
-    const bool isHovered = m_menuButtons->hovered();
+    const bool isHovered = m_menuButtons && m_menuButtons->hovered();
     const bool revealingOnHover = showCaptionOnHover() && m_captionLimited && isHovered;
 
     if (spaceLimited && !revealingOnHover) {
@@ -1287,14 +1599,14 @@ void Decoration::paintCaption(QPainter *painter, const QRectF &repaintRegion) co
 
     // 5. Final drawing geometry and alignment
     QRectF availableRect = (revealingOnHover ? centerRect() : constrainedRect);
-    const qreal padding = m_internalSettings->menuButtonHorzPadding();
+    const qreal padding = m_internalSettings->menuButtonHorzPadding;
     availableRect.adjust(padding, 0, -padding, 0);
 
     QRectF drawingRect;
     Qt::Alignment alignment;
     const QRectF idealRect((size().width() - textWidth) / 2.0, 0, textWidth, titleBarHeight());
 
-    switch (m_internalSettings->titleAlignment()) {
+    switch (m_internalSettings->titleAlignment) {
     case InternalSettings::AlignLeft:
         drawingRect = availableRect;
         alignment = Qt::AlignLeft;
@@ -1347,19 +1659,67 @@ void Decoration::paintCaption(QPainter *painter, const QRectF &repaintRegion) co
         }
     }
 
-    if (m_captionCache.availableWidth != drawingRect.width() || m_captionCache.alignment != alignment) {
-        m_captionCache.availableWidth = drawingRect.width();
-        m_captionCache.alignment = alignment;
-        m_captionCache.elidedCaption = getFontMetrics().elidedText(fullCaption, Qt::ElideMiddle, drawingRect.width());
-    }    
-    
+    const QStaticText &caption = preparedCaption(fullCaption, font, drawingRect.width(), alignment);
+    const QSizeF captionSize = caption.size();
+
+    // Same placement as drawText() with alignment | Qt::AlignVCenter.
+    qreal x = drawingRect.left();
+    if (alignment & Qt::AlignRight) {
+        x = drawingRect.right() - captionSize.width();
+    } else if (alignment & Qt::AlignHCenter) {
+        x = drawingRect.left() + (drawingRect.width() - captionSize.width()) / 2.0;
+    }
+    const qreal y = drawingRect.top() + (drawingRect.height() - captionSize.height()) / 2.0;
 
-    painter->drawText(drawingRect, alignment | Qt::TextSingleLine | Qt::AlignVCenter, m_captionCache.elidedCaption);
+    painter->drawStaticText(QPointF(x, y), caption);
     painter->restore();
 }
 
+const QStaticText &Decoration::preparedCaption(const QString &caption,
+                                               const QFont &font,
+                                               qreal availableWidth,
+                                               Qt::Alignment alignment) const
+{
+    ++m_captionClock;
+
+    PreparedCaption *oldest = nullptr;
+    for (PreparedCaption &entry : m_preparedCaptions) {
+        if (entry.availableWidth == availableWidth && entry.alignment == alignment
+            && entry.caption == caption && entry.font == font) {
+            entry.lastUsed = m_captionClock;
+            return entry.text;
+        }
+        if (!oldest || entry.lastUsed < oldest->lastUsed) {
+            oldest = &entry;
+        }
+    }
+
+    // Windows whose caption changes all the time (terminals, media players)
+    // often go back to one they showed recently, so keep a few around.
+    static constexpr int s_capacity = 4;
+    if (m_preparedCaptions.size() < s_capacity) {
+        oldest = &m_preparedCaptions.emplace_back();
+    }
+
+    oldest->caption = caption;
+    oldest->font = font;
+    oldest->availableWidth = availableWidth;
+    oldest->alignment = alignment;
+    oldest->lastUsed = m_captionClock;
+    // QStaticText would break lines where drawText() with Qt::TextSingleLine doesn't.
+    QString singleLine = caption;
+    singleLine.replace(QLatin1Char('\n'), QLatin1Char(' '));
+    oldest->text = QStaticText(QFontMetricsF(font).elidedText(singleLine, Qt::ElideMiddle, availableWidth));
+    oldest->text.setTextFormat(Qt::PlainText);
+    oldest->text.setPerformanceHint(QStaticText::AggressiveCaching);
+    oldest->text.prepare(QTransform(), font);
+    return oldest->text;
+}
+
 void Decoration::paintButtons(QPainter *painter, const QRectF &repaintRegion) const
 {
+    const ProfileScope scope(PaintProfiler::Buttons);
+
     if (hideTitleBar()) {
         return;
     }
@@ -1379,11 +1739,11 @@ void Decoration::updateCornerRadiusAndOutline()
     if (!m_internalSettings) {
         return;
     }
-    if (m_internalSettings->squareCorners() || window()->isMaximized() || !settings()->isAlphaChannelSupported()) {
+    if (m_internalSettings->squareCorners || window()->isMaximized() || !settings()->isAlphaChannelSupported()) {
         m_cornerRadius = 0.0;
     } else {
-        // m_cornerRadius = m_internalSettings->cornerRadius();
-        m_cornerRadius = KDecoration3::snapToPixelGrid(m_internalSettings->cornerRadius(), window()->nextScale());
+        // m_cornerRadius = m_internalSettings->cornerRadius;
+        m_cornerRadius = KDecoration3::snapToPixelGrid(m_internalSettings->cornerRadius, window()->nextScale());
     }
     
     const qreal topLeftCornerRadius = leftBorderVisible() ? m_cornerRadius : 0.0;
@@ -1399,7 +1759,7 @@ void Decoration::updateCornerRadiusAndOutline()
     setBorderRadius(radius);
     
     //Outline
-    if (m_internalSettings->outlineActive()) {
+    if (m_internalSettings->outlineActive) {
         QColor outlineColor = borderColor();
         outlineColor.setAlphaF(1.0);
         const qreal outlineThickness = std::max(KDecoration3::pixelSize(window()->nextScale()), KDecoration3::snapToPixelGrid(1, window()->nextScale()));
@@ -1411,6 +1771,24 @@ void Decoration::updateCornerRadiusAndOutline()
 
 void Decoration::updatePaths()
 {
+    const QPainterPath framePath = m_framePath;
+    const QPainterPath titleBarPath = m_titleBarPath;
+    const QPainterPath borderPath = m_borderPath;
+
+    buildPaths();
+
+    // Most layout passes leave the shapes as they were, and the cached
+    // background only has to be rendered again when they change.
+    if (m_framePath != framePath || m_titleBarPath != titleBarPath || m_borderPath != borderPath) {
+        ++m_pathsSerial;
+    }
+}
+
+void Decoration::buildPaths()
+{
+    // Without any rounded corner every shape is a plain rectangle.
+    m_squareCorners = m_cornerRadius <= 0 || (!leftBorderVisible() && !rightBorderVisible());
+
     m_framePath = getRoundedPath(rect(),
                                  m_cornerRadius,
                                  leftBorderVisible(),
@@ -1420,6 +1798,9 @@ void Decoration::updatePaths()
 
     if (hideTitleBar()) {
         m_titleBarPath = QPainterPath();
+        m_titleBarRect = QRectF();
+        m_borderPath = m_framePath;
+        m_borderRects = {QRectF(rect())};
         return;
     }
 
@@ -1428,12 +1809,33 @@ void Decoration::updatePaths()
     const qreal right = rightOffset();
     const QRectF titleBarBackgroundRect(left, top, size().width() - left - right, titleBarHeight() + 1);
     
+    m_titleBarRect = titleBarBackgroundRect;
     m_titleBarPath = getRoundedPath(titleBarBackgroundRect,
                                     m_cornerRadius,
                                     leftBorderVisible(),
                                     rightBorderVisible(),
                                     false,
                                     false);
+
+    // The borders are whatever the title bar doesn't cover. Work it out
+    // once here rather than with a path boolean operation on every paint.
+    m_borderRects.clear();
+    if (m_squareCorners) {
+        m_borderPath = QPainterPath();
+
+        const QRectF frameRect = rect();
+        const QRectF topRect(frameRect.left(), frameRect.top(), frameRect.width(), m_titleBarRect.top() - frameRect.top());
+        const QRectF leftRect(frameRect.left(), m_titleBarRect.top(), m_titleBarRect.left() - frameRect.left(), m_titleBarRect.height());
+        const QRectF rightRect(m_titleBarRect.right(), m_titleBarRect.top(), frameRect.right() - m_titleBarRect.right(), m_titleBarRect.height());
+        const QRectF bottomRect(frameRect.left(), m_titleBarRect.bottom(), frameRect.width(), frameRect.bottom() - m_titleBarRect.bottom());
+        for (const QRectF &borderRect : {topRect, leftRect, rightRect, bottomRect}) {
+            if (borderRect.isValid()) {
+                m_borderRects.append(borderRect);
+            }
+        }
+    } else {
+        m_borderPath = m_framePath.subtracted(m_titleBarPath);
+    }
 }
 
 void Decoration::onSizeChanged()
@@ -1447,46 +1849,56 @@ void Decoration::onNextScaleChanged()
 {
     updateBordersCornersBlurShadow();
     updateResizeBorders();
+    updateButtonsGeometryDelayed();
     updateTitleBar();
-    updateButtonsGeometry();
 }
 
 void Decoration::onWidthChanged()
 {
+    updateButtonsGeometryDelayed();
     updateTitleBar();
-    updateButtonsGeometry();
 }
 
 void Decoration::onMaximizedChanged()
 {
     updateBordersCornersBlurShadow();
-    updateButtonsGeometry();
+    updateButtonsGeometryDelayed();
     updateTitleBar();
 }
 
 void Decoration::onShadedChanged()
 {
     updateBordersCornersBlurShadow();
-    updateButtonsGeometry();
+    updateButtonsGeometryDelayed();
 }
 
 void Decoration::onActiveChanged()
 {
     updateColors();
     updateCornerRadiusAndOutline();
-    update();
+    updateFrame();
 }
 
-void Decoration::onAdjacentScreenEdgesChanged()
+void Decoration::updateFrame()
 {
-    updateBordersCornersBlurShadow();
-    updateTitleBar();
-    updateButtonsGeometry();
+    // Everything but the window contents.
+    // Borders can be fractional at scales other than 1. Shrink the window
+    // contents to whole pixels so that the region always covers the
+    // innermost, partially covered pixel of every border.
+    const QRect frame = rect().toAlignedRect();
+    const QRectF contents = rect().marginsRemoved(borders());
+    const QRect inner(QPoint(qCeil(contents.left()), qCeil(contents.top())),
+                      QPoint(qFloor(contents.right()) - 1, qFloor(contents.bottom()) - 1));
+    const QRegion region = QRegion(frame) - QRegion(inner);
+    for (const QRect &rect : region) {
+        update(rect);
+    }
 }
 
-void Decoration::onSpacingChanged()
+void Decoration::onAdjacentScreenEdgesChanged()
 {
     updateBordersCornersBlurShadow();
+    updateTitleBar();
     updateButtonsGeometryDelayed();
 }
 
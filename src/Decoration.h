@@ -23,18 +23,27 @@
 #include "BuildConfig.h"
 #include "AppMenuButtonGroup.h"
 #include "InternalSettings.h"
+#include "ResolvedSettings.h"
+#include "SettingsProvider.h"
+#include "ShadowCache.h"
 
 // KDecoration
 #include <KDecoration3/Decoration>
 
 // Qt
 #include <QHoverEvent>
+#include <QImage>
 #include <QMouseEvent>
 #include <QRectF>
-#include <QSharedPointer>
 #include <QWheelEvent>
 #include <QVariant>
 #include <QPainterPath>
+#include <QStaticText>
+
+// std
+#include <optional>
+
+class QTimer;
 
 namespace KDecoration3
 {
@@ -60,7 +69,6 @@ public:
 
 public slots:
     bool init() override;
-    void reconfigure();
 
 private slots:
     void onTabletModeChanged(bool mode);
@@ -82,7 +90,8 @@ private:
     void onShadedChanged();
     void onActiveChanged();
     void onAdjacentScreenEdgesChanged();
-    void onSpacingChanged();
+    void onShadowReady(const ShadowKey &key);
+    void onSettingsChanged(int changes); // SettingsChange flags, on top of what the settings themselves changed
 
 private:
     QRectF titleBarRect() const;
@@ -107,11 +116,14 @@ private:
     qreal bottomOffset() const { return bottomBorderVisible() ? bottomBorderSize() : 0; }
 
     void setupMenu();
+    void updateMenuPresence(); // create or drop the menu group as the window's menu comes and goes
+    void teardownMenu();
     void updateBlur();
     void updateBordersCornersBlurShadow();
     void updateResizeBorders();
     void updateTitleBar();
     void updateTitleBarHoverState();
+    void updateFrame(); // repaint the title bar and borders
 
     void setButtonGroupHeight(KDecoration3::DecorationButtonGroup *buttonGroup, qreal buttonHeight);
     void setButtonGroupHorzPadding(KDecoration3::DecorationButtonGroup *buttonGroup, qreal value);
@@ -123,13 +135,13 @@ private:
     void setButtonGroupAnimation(KDecoration3::DecorationButtonGroup *buttonGroup, bool enabled, int duration);
     void updateButtonAnimation();
     void updateShadow();
-    std::shared_ptr<KDecoration3::DecorationShadow> createShadowObject(const float strengthScale);
     void updateCornerRadiusAndOutline();
     void updatePaths();
+    void buildPaths();
 
     bool hideTitleBar() const;
-    void setInternalSettings(const QSharedPointer<InternalSettings> &settings);
-    void applySettings();
+    void setInternalSettings(const ResolvedSettingsPtr &settings);
+    void applySettings(int changes = SettingsChange::All); // SettingsChange flags
 
     bool menuAlwaysShow() const;
     bool useSystemMenuFont() const;
@@ -168,7 +180,12 @@ private:
 
     void paintFrameBackground(QPainter *painter, const QRectF &repaintRegion) const;
     void paintTitleBarBackground(QPainter *painter, const QRectF &repaintRegion) const;
+    bool paintCachedBackground(QPainter *painter, const QRectF &repaintRegion) const;
     void paintCaption(QPainter *painter, const QRectF &repaintRegion) const;
+    const QStaticText &preparedCaption(const QString &caption,
+                                       const QFont &font,
+                                       qreal availableWidth,
+                                       Qt::Alignment alignment) const;
     void paintButtons(QPainter *painter, const QRectF &repaintRegion) const;
     QPainterPath getRoundedPath(const QRectF &rect, qreal radius, bool roundTopLeft = true, bool roundTopRight = true, bool roundBottomLeft = false, bool roundBottomRight = false) const;
 
@@ -177,15 +194,41 @@ private:
     KDecoration3::DecorationButtonGroup *m_leftButtons = nullptr;
     KDecoration3::DecorationButtonGroup *m_rightButtons = nullptr;
     AppMenuButtonGroup *m_menuButtons = nullptr;
+    QTimer *m_menuTeardownTimer = nullptr; // Delays dropping the menu group
 
-    QSharedPointer<InternalSettings> m_internalSettings;
+    ResolvedSettingsPtr m_internalSettings;
+    SettingsProvider::Resolution m_settingsResolution;
     qreal m_cornerRadius = 0.0;
     bool m_bottomCornersFlag = true;
+    std::optional<ShadowKey> m_pendingShadowKey;
+    bool m_layoutPending = false;
+    bool m_inLayout = false;
 
     QPoint m_pressedPoint;
 
     QPainterPath m_framePath;
     QPainterPath m_titleBarPath;
+    QPainterPath m_borderPath;
+    QList<QRectF> m_borderRects; // Only used with square corners
+    QRectF m_titleBarRect;
+    bool m_squareCorners = false;
+    quint64 m_pathsSerial = 0; // Bumped by updatePaths() when a path changes
+
+    // Pre-rendered title bar and frame with rounded corners, one per
+    // activation state, when MATERIAL_DECORATION_BACKGROUND_CACHE is set.
+    // The top strip holds the title bar, the bottom strip the bottom
+    // corners; the straight side borders in between are plain rectangles.
+    struct BackgroundCache {
+        quint64 pathsSerial = 0;
+        qreal devicePixelRatio = 0;
+        QColor titleBarColor;
+        QColor borderColor;
+        qreal topHeight = 0;
+        qreal bottomTop = 0;
+        QImage top;
+        QImage bottom;
+    };
+    mutable BackgroundCache m_backgroundCache[2]; // inactive, active
 
     QColor m_titleBarBackgroundColor;
     QColor m_titleBarOpaqueBackgroundColor;
@@ -196,11 +239,20 @@ private:
     mutable struct {
         QString fullCaption;
         qreal textWidth = -1.0;
-        qreal availableWidth = -1.0;
-        Qt::Alignment alignment = Qt::AlignCenter;
-        QString elidedCaption;
         QFont font;
     } m_captionCache;
+
+    // Recently painted captions, elided and laid out, ready to draw.
+    struct PreparedCaption {
+        QString caption;
+        QFont font;
+        qreal availableWidth = -1.0;
+        Qt::Alignment alignment = Qt::AlignCenter;
+        QStaticText text;
+        quint64 lastUsed = 0;
+    };
+    mutable QList<PreparedCaption> m_preparedCaptions;
+    mutable quint64 m_captionClock = 0;
     
     QPointF m_lastHoverPos;
     bool m_titleBarHoverActive = false;
@@ -211,6 +263,7 @@ private:
     friend class AppIconButton;
     friend class AppMenuButton;
     friend class TextButton;
+    friend class SettingsDispatcher;
 };
 
 } // namespace Material
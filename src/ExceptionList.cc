@@ -23,6 +23,52 @@
 namespace Material
 {
 
+namespace
+{
+
+const int s_defaultMask = ExceptionMask::HideTitleBar |
+                          ExceptionMask::HideApplicationMenu |
+                          ExceptionMask::HamburgerMenu |
+                          ExceptionMask::HideShadow |
+                          ExceptionMask::SquareCorners |
+                          ExceptionMask::OutlineActive;
+
+// The "Windeco Exception <n>" groups, by index.
+QStringList exceptionGroups(const KSharedConfig::Ptr &config)
+{
+    const QString prefix = QStringLiteral("Windeco Exception ");
+    const QStringList groupList = config->groupList();
+
+    struct IndexedGroup {
+        int index;
+        QString name;
+    };
+    QList<IndexedGroup> exceptionGroups;
+
+    for (const QString &groupName : groupList) {
+        if (groupName.startsWith(prefix)) {
+            bool ok = false;
+            int index = groupName.mid(prefix.length()).toInt(&ok);
+            if (ok) {
+                exceptionGroups.append({index, groupName});
+            }
+        }
+    }
+
+    std::sort(exceptionGroups.begin(), exceptionGroups.end(), [](const IndexedGroup &a, const IndexedGroup &b) {
+        return a.index < b.index;
+    });
+
+    QStringList names;
+    names.reserve(exceptionGroups.size());
+    for (const auto &grp : std::as_const(exceptionGroups)) {
+        names.append(grp.name);
+    }
+    return names;
+}
+
+} // anonymous namespace
+
 void copyInternalSettings(const InternalSettingsPtr &src, const InternalSettingsPtr &dst)
 {
     if (!src || !dst) {
@@ -82,51 +128,48 @@ InternalSettingsPtr cloneInternalSettings(const InternalSettingsPtr &src)
     return copy;
 }
 
-void ExceptionList::readConfig(const KSharedConfig::Ptr &config)
+QList<ExceptionEntry> readExceptionEntries(const KSharedConfig::Ptr &config)
 {
-    m_exceptions.clear();
-
-    const QString prefix = QStringLiteral("Windeco Exception ");
-    const QStringList groupList = config->groupList();
-
-    struct IndexedGroup {
-        int index;
-        QString name;
-    };
-    QList<IndexedGroup> exceptionGroups;
-
-    for (const QString &groupName : groupList) {
-        if (groupName.startsWith(prefix)) {
-            bool ok = false;
-            int index = groupName.mid(prefix.length()).toInt(&ok);
-            if (ok) {
-                exceptionGroups.append({index, groupName});
-            }
-        }
+    QList<ExceptionEntry> entries;
+
+    for (const QString &groupName : exceptionGroups(config)) {
+        const KConfigGroup group = config->group(groupName);
+
+        ExceptionEntry entry;
+        entry.pattern = group.readEntry("ExceptionPattern", QString());
+        entry.type = static_cast<ExceptionType>(group.readEntry("ExceptionType", static_cast<int>(entry.type)));
+        entry.matchingMode = static_cast<MatchingMode>(group.readEntry("MatchingMode", static_cast<int>(entry.matchingMode)));
+        entry.enabled = group.readEntry("Enabled", entry.enabled);
+        entry.mask = group.readEntry("Mask", s_defaultMask);
+        entry.hideTitleBar = group.readEntry("HideTitleBar", entry.hideTitleBar);
+        entry.hideApplicationMenu = group.readEntry("HideApplicationMenu", entry.hideApplicationMenu);
+        entry.hamburgerMenu = group.readEntry("HamburgerMenu", entry.hamburgerMenu);
+        entry.hideShadow = group.readEntry("HideShadow", entry.hideShadow);
+        entry.squareCorners = group.readEntry("SquareCorners", entry.squareCorners);
+        entry.outlineActive = group.readEntry("OutlineActive", entry.outlineActive);
+
+        entries.append(entry);
     }
 
-    std::sort(exceptionGroups.begin(), exceptionGroups.end(), [](const IndexedGroup &a, const IndexedGroup &b) {
-        return a.index < b.index;
-    });
+    return entries;
+}
 
-    for (const auto &grp : exceptionGroups) {
+void ExceptionList::readConfig(const KSharedConfig::Ptr &config)
+{
+    m_exceptions.clear();
+
+    for (const QString &groupName : exceptionGroups(config)) {
         InternalSettingsPtr exception(new InternalSettings());
-        exception->setCurrentGroup(grp.name);
+        exception->setCurrentGroup(groupName);
         exception->load();
 
-        KConfigGroup group = config->group(grp.name);
+        KConfigGroup group = config->group(groupName);
         exception->setExceptionPattern(group.readEntry("ExceptionPattern", exception->exceptionPattern()));
         exception->setExceptionType(group.readEntry("ExceptionType", exception->exceptionType()));
         exception->setMatchingMode(group.readEntry("MatchingMode", exception->matchingMode()));
         exception->setEnabled(group.readEntry("Enabled", exception->enabled()));
 
-        const int defaultMask = ExceptionMask::HideTitleBar |
-                                ExceptionMask::HideApplicationMenu |
-                                ExceptionMask::HamburgerMenu |
-                                ExceptionMask::HideShadow |
-                                ExceptionMask::SquareCorners |
-                                ExceptionMask::OutlineActive;
-        const int mask = group.readEntry("Mask", defaultMask);
+        const int mask = group.readEntry("Mask", s_defaultMask);
         exception->setMask(mask);
         exception->setHideTitleBar(group.readEntry("HideTitleBar", exception->hideTitleBar()));
         exception->setHideApplicationMenu(group.readEntry("HideApplicationMenu", exception->hideApplicationMenu()));
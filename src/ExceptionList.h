@@ -50,8 +50,29 @@ enum ExceptionMask {
 };
 
 void copyInternalSettings(const InternalSettingsPtr &src, const InternalSettingsPtr &dst);
+
 InternalSettingsPtr cloneInternalSettings(const InternalSettingsPtr &src);
 
+/**
+ * The fields of an exception group that the decoration needs, read
+ * without loading a whole InternalSettings for every group.
+ **/
+struct ExceptionEntry {
+    QString pattern;
+    ExceptionType type = ExceptionType::WindowClass;
+    MatchingMode matchingMode = MatchingMode::ExactMatch;
+    bool enabled = true;
+    int mask = ExceptionMask::None;
+    bool hideTitleBar = false;
+    bool hideApplicationMenu = false;
+    bool hamburgerMenu = false;
+    bool hideShadow = false;
+    bool squareCorners = false;
+    bool outlineActive = false;
+};
+
+QList<ExceptionEntry> readExceptionEntries(const KSharedConfig::Ptr &config);
+
 class ExceptionList
 {
 public:
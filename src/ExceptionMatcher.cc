@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ExceptionMatcher.h"
+#include "Material.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <climits>
+
+namespace Material
+{
+
+namespace
+{
+
+// Constructs whose meaning depends on the group numbering, on where the
+// match starts or on the rest of the expression (extended mode comments
+// run to the end), and would change when merged with other patterns.
+// Conditionals are rejected too, (?(1)...) tests a group by number.
+bool canCombine(const QString &pattern)
+{
+    static const QRegularExpression unsafe(QStringLiteral(R"(\\[1-9gkG]|\(\?(\(|P[=>]|[+-]?\d|R|&|[a-zA-Z^-]*x))"));
+    return !unsafe.match(pattern).hasMatch();
+}
+
+// The components of a window class are separated by whitespace or NUL.
+bool isClassSeparator(QChar c)
+{
+    return c == QLatin1Char(' ') || c == QLatin1Char('\t') || c == QLatin1Char('\n')
+        || c == QLatin1Char('\v') || c == QLatin1Char('\f') || c == QLatin1Char('\r')
+        || c.isNull();
+}
+
+} // anonymous namespace
+
+void ExceptionMatcher::compile(const QList<Rule> &rules)
+{
+    m_titleExact.clear();
+    m_classExact.clear();
+    m_titleRegex = RegexSet();
+    m_classRegex = RegexSet();
+
+    for (int i = 0; i < rules.size(); ++i) {
+        const Rule &rule = rules.at(i);
+        const bool title = rule.type == ExceptionType::WindowTitle;
+        if (rule.matchingMode == MatchingMode::ExactMatch) {
+            addExact(title ? m_titleExact : m_classExact, rule.pattern, i);
+        } else {
+            (title ? m_titleRegex : m_classRegex).add(i, rule.pattern);
+        }
+    }
+
+    m_titleRegex.compile();
+    m_classRegex.compile();
+    m_hasTitleRules = !m_titleExact.isEmpty() || m_titleRegex.combinedCount() > 0 || m_titleRegex.separateCount() > 0;
+
+    qCDebug(category) << "Exception matcher:" << rules.size() << "rules |"
+                      << "exact" << m_titleExact.size() << "title" << m_classExact.size() << "class |"
+                      << "combined" << m_titleRegex.combinedCount() << "title" << m_classRegex.combinedCount() << "class |"
+                      << "separate" << m_titleRegex.separateCount() + m_classRegex.separateCount();
+}
+
+void ExceptionMatcher::addExact(QHash<QString, int> &hash, const QString &pattern, int rule)
+{
+    // Keep the earliest rule for a pattern.
+    hash.insert(pattern.toCaseFolded(), std::min(rule, hash.value(pattern.toCaseFolded(), rule)));
+}
+
+int ExceptionMatcher::match(const QString &caption, const QString &windowClass) const
+{
+    int best = INT_MAX;
+    auto consider = [&best](int rule) {
+        if (rule >= 0 && rule < best) {
+            best = rule;
+        }
+    };
+
+    if (!m_titleExact.isEmpty()) {
+        consider(m_titleExact.value(caption.toCaseFolded(), -1));
+    }
+
+    if (!m_classExact.isEmpty()) {
+        // The whole class, then each of its components.
+        const QString folded = windowClass.toCaseFolded();
+        consider(m_classExact.value(folded, -1));
+
+        qsizetype start = 0;
+        for (qsizetype i = 0; i <= folded.size(); ++i) {
+            if (i == folded.size() || isClassSeparator(folded.at(i))) {
+                if (i > start) {
+                    consider(m_classExact.value(folded.mid(start, i - start), -1));
+                }
+                start = i + 1;
+            }
+        }
+    }
+
+    consider(m_titleRegex.match(caption, best));
+    consider(m_classRegex.match(windowClass, best));
+
+    return best == INT_MAX ? -1 : best;
+}
+
+void ExceptionMatcher::RegexSet::add(int rule, const QString &pattern)
+{
+    if (canCombine(pattern)) {
+        m_pendingRules.append(rule);
+        m_pendingPatterns.append(pattern);
+    } else {
+        m_separate.append(Separate{rule, QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption)});
+    }
+}
+
+void ExceptionMatcher::RegexSet::compile()
+{
+    if (m_pendingRules.isEmpty()) {
+        return;
+    }
+
+    // Every rule is a lookahead that searches the whole subject, tried in
+    // order from the start, followed by an empty marker group. The first
+    // alternative that succeeds is the first rule that matches.
+    QString combined = QStringLiteral("^(?:");
+    QList<int> markerGroups;
+    int groups = 0;
+    for (int i = 0; i < m_pendingPatterns.size(); ++i) {
+        const QString &pattern = m_pendingPatterns.at(i);
+        groups += QRegularExpression(pattern).captureCount() + 1;
+        markerGroups.append(groups);
+
+        if (i > 0) {
+            combined += QLatin1Char('|');
+        }
+        combined += QStringLiteral("(?=[\\s\\S]*?(?:%1))()").arg(pattern);
+    }
+    combined += QLatin1Char(')');
+
+    QRegularExpression regex(combined, QRegularExpression::CaseInsensitiveOption);
+    if (!regex.isValid()) {
+        // Something like a duplicate group name across rules.
+        qCDebug(category) << "Exception matcher: cannot combine the rules," << regex.errorString();
+        for (int i = 0; i < m_pendingRules.size(); ++i) {
+            m_separate.append(Separate{m_pendingRules.at(i), QRegularExpression(m_pendingPatterns.at(i), QRegularExpression::CaseInsensitiveOption)});
+        }
+    } else {
+        regex.optimize();
+        m_combined = regex;
+        m_combinedRules = m_pendingRules;
+        m_markerGroups = markerGroups;
+    }
+
+    m_pendingRules.clear();
+    m_pendingPatterns.clear();
+    std::sort(m_separate.begin(), m_separate.end(), [](const Separate &a, const Separate &b) {
+        return a.rule < b.rule;
+    });
+}
+
+int ExceptionMatcher::RegexSet::match(const QString &subject, int limit) const
+{
+    int best = -1;
+
+    if (!m_combinedRules.isEmpty() && m_combinedRules.constFirst() < limit) {
+        const QRegularExpressionMatch match = m_combined.match(subject);
+        if (match.hasMatch()) {
+            for (int i = 0; i < m_markerGroups.size(); ++i) {
+                if (match.capturedStart(m_markerGroups.at(i)) >= 0) {
+                    if (m_combinedRules.at(i) < limit) {
+                        best = m_combinedRules.at(i);
+                        limit = best;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const Separate &separate : m_separate) {
+        if (separate.rule >= limit) {
+            break;
+        }
+        if (separate.regex.match(subject).hasMatch()) {
+            return separate.rule;
+        }
+    }
+
+    return best;
+}
+
+} // namespace Material
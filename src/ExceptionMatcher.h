@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ExceptionList.h"
+
+#include <QHash>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+namespace Material
+{
+
+/**
+ * Window exception rules, compiled for matching many windows against.
+ *
+ * Exact rules are looked up in case-folded hashes, and the regular
+ * expression rules of each type are merged into a single expression that
+ * reports the first rule that matches. The result is always the same as
+ * trying the rules one by one, in order.
+ **/
+class ExceptionMatcher
+{
+public:
+    struct Rule {
+        ExceptionType type = ExceptionType::WindowTitle;
+        MatchingMode matchingMode = MatchingMode::ExactMatch;
+        QString pattern;
+
+        bool operator==(const Rule &other) const = default;
+    };
+
+    /**
+     * Replace the rules. Earlier rules take precedence over later ones.
+     * Invalid regular expressions must have been filtered out already.
+     **/
+    void compile(const QList<Rule> &rules);
+
+    /**
+     * The index of the first rule matching a window, or -1.
+     **/
+    int match(const QString &caption, const QString &windowClass) const;
+
+    /**
+     * Whether the result can depend on the window caption at all.
+     **/
+    bool hasTitleRules() const { return m_hasTitleRules; }
+
+private:
+    // The regular expression rules of one exception type.
+    class RegexSet
+    {
+    public:
+        void add(int rule, const QString &pattern);
+        void compile();
+
+        /**
+         * The first rule that matches @p subject, if it comes before
+         * @p limit, otherwise -1.
+         **/
+        int match(const QString &subject, int limit) const;
+
+        int combinedCount() const { return m_combinedRules.size(); }
+        int separateCount() const { return m_separate.size(); }
+
+    private:
+        struct Separate {
+            int rule;
+            QRegularExpression regex;
+        };
+
+        QList<int> m_pendingRules;
+        QStringList m_pendingPatterns;
+
+        QRegularExpression m_combined;
+        QList<int> m_combinedRules;
+        QList<int> m_markerGroups; // capture group that flags each combined rule
+        QList<Separate> m_separate;
+    };
+
+    static void addExact(QHash<QString, int> &hash, const QString &pattern, int rule);
+
+    QHash<QString, int> m_titleExact;
+    QHash<QString, int> m_classExact;
+    RegexSet m_titleRegex;
+    RegexSet m_classRegex;
+    bool m_hasTitleRules = false;
+};
+
+} // namespace Material
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "GlyphCache.h"
+#include "Material.h"
+
+// KF
+#include <KIconLoader>
+
+// Qt
+#include <QDebug>
+
+namespace Material
+{
+
+GlyphCache *GlyphCache::self()
+{
+    static GlyphCache s_self;
+    return &s_self;
+}
+
+GlyphCache::GlyphCache()
+    : m_glyphs(s_capacity)
+    , m_icons(s_iconCapacity)
+{
+    // A new icon theme keeps the QIcon cache keys, so the window icons
+    // rendered from the old one would never be replaced.
+    auto *iconLoader = KIconLoader::global();
+    QObject::connect(iconLoader, &KIconLoader::iconChanged, &m_iconThemeWatcher, [this] {
+        clearIcons();
+    });
+    QObject::connect(iconLoader, &KIconLoader::iconLoaderSettingsChanged, &m_iconThemeWatcher, [this] {
+        clearIcons();
+    });
+}
+
+QPixmap GlyphCache::glyph(const GlyphKey &key, const Renderer &renderer)
+{
+    if (const QPixmap *glyph = m_glyphs.object(key)) {
+        ++m_hits;
+        return *glyph;
+    }
+
+    ++m_misses;
+    const QPixmap glyph = renderer();
+    if (!glyph.isNull()) {
+        m_glyphs.insert(key, new QPixmap(glyph));
+    }
+
+    qCDebug(category) << "Glyph cache miss: type" << key.buttonType
+                      << "size" << key.physicalSize
+                      << "dpr" << key.devicePixelRatio
+                      << "| entries" << m_glyphs.size()
+                      << "hits" << m_hits
+                      << "misses" << m_misses;
+    return glyph;
+}
+
+QPixmap GlyphCache::icon(const IconKey &key, const Renderer &renderer)
+{
+    if (const QPixmap *icon = m_icons.object(key)) {
+        return *icon;
+    }
+
+    const QPixmap icon = renderer();
+    if (!icon.isNull()) {
+        m_icons.insert(key, new QPixmap(icon));
+    }
+    return icon;
+}
+
+void GlyphCache::clear()
+{
+    m_glyphs.clear();
+    m_icons.clear();
+}
+
+void GlyphCache::clearIcons()
+{
+    m_icons.clear();
+}
+
+} // namespace Material
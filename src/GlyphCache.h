@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QCache>
+#include <QColor>
+#include <QHashFunctions>
+#include <QObject>
+#include <QPixmap>
+#include <QSize>
+
+// std
+#include <functional>
+
+namespace Material
+{
+
+/**
+ * Everything that influences the pixels of a button glyph.
+ **/
+struct GlyphKey {
+    int buttonType = 0;
+    bool checked = false;
+    QRgb color = 0;
+    int physicalSize = 0;
+    qreal devicePixelRatio = 1.0; ///< physical pixels per logical pixel, including the painter's scale
+    qreal windowScale = 1.0;
+
+    bool operator==(const GlyphKey &other) const = default;
+};
+
+inline size_t qHash(const GlyphKey &key, size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, key.buttonType, key.checked, key.color, key.physicalSize, key.devicePixelRatio, key.windowScale);
+}
+
+/**
+ * Everything that influences the pixels of a window icon.
+ **/
+struct IconKey {
+    qint64 iconCacheKey = 0;
+    QRgb color = 0; ///< used to colorize symbolic icons
+    QSize size;
+    qreal devicePixelRatio = 1.0;
+
+    bool operator==(const IconKey &other) const = default;
+};
+
+inline size_t qHash(const IconKey &key, size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, key.iconCacheKey, key.color, key.size.width(), key.size.height(), key.devicePixelRatio);
+}
+
+/**
+ * Process-wide cache of rasterized button glyphs and window icons.
+ *
+ * The vector icons of the titlebar buttons are stroked once per key and
+ * blitted afterwards, and window icons are only loaded once per size and
+ * color. All decorations share the cache, which drops the least recently
+ * used pixmaps once it is full. The window icons are dropped when the
+ * icon theme changes.
+ **/
+class GlyphCache
+{
+public:
+    using Renderer = std::function<QPixmap()>;
+
+    static GlyphCache *self();
+
+    /**
+     * Return the glyph for @p key, calling @p renderer to create it on a miss.
+     **/
+    QPixmap glyph(const GlyphKey &key, const Renderer &renderer);
+
+    /**
+     * Return the window icon for @p key, calling @p renderer to create it on a miss.
+     **/
+    QPixmap icon(const IconKey &key, const Renderer &renderer);
+
+    void clear();
+    void clearIcons();
+
+private:
+    GlyphCache();
+
+    static constexpr int s_capacity = 64;
+    static constexpr int s_iconCapacity = 32;
+
+    QCache<GlyphKey, QPixmap> m_glyphs;
+    QCache<IconKey, QPixmap> m_icons;
+    QObject m_iconThemeWatcher; // context of the icon loader connections
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+} // namespace Material
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "PaintProfiler.h"
+#include "Material.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDebug>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// std
+#include <algorithm>
+
+namespace Material
+{
+
+PaintProfiler *PaintProfiler::self()
+{
+    static PaintProfiler s_self;
+    return &s_self;
+}
+
+PaintProfiler::PaintProfiler()
+{
+    const QString path = QStringLiteral("/MaterialDecoration/Stats");
+    if (!QDBusConnection::sessionBus().registerObject(path, this, QDBusConnection::ExportScriptableSlots)) {
+        qCDebug(category) << "Paint profiler: could not register" << path << "on the session bus";
+    }
+}
+
+void PaintProfiler::record(Stage stage, qint64 nsecs)
+{
+    Histogram &histogram = m_stages[stage];
+    histogram.samples[histogram.count % s_window] = nsecs;
+    histogram.max = std::max(histogram.max, nsecs);
+    ++histogram.count;
+}
+
+QString PaintProfiler::report() const
+{
+    static const char *const names[StageCount] = {
+        "paint",
+        "paintFrameBackground",
+        "paintTitleBarBackground",
+        "paintButtons",
+        "paintCaption",
+        "updateShadow",
+        "updateButtonsGeometry",
+    };
+
+    QString result;
+    for (int stage = 0; stage < StageCount; ++stage) {
+        const Histogram &histogram = m_stages[stage];
+        const int size = std::min<quint64>(histogram.count, s_window);
+
+        qint64 p50 = 0;
+        qint64 p99 = 0;
+        if (size > 0) {
+            QVarLengthArray<qint64, s_window> sorted(histogram.samples.cbegin(), histogram.samples.cbegin() + size);
+            std::sort(sorted.begin(), sorted.end());
+            p50 = sorted[(size - 1) / 2];
+            p99 = sorted[(size - 1) * 99 / 100];
+        }
+
+        result += QStringLiteral("%1 count %2 p50 %3 p99 %4 max %5\n")
+                      .arg(QLatin1String(names[stage]), -24)
+                      .arg(histogram.count)
+                      .arg(p50 / 1000.0, 0, 'f', 1)
+                      .arg(p99 / 1000.0, 0, 'f', 1)
+                      .arg(histogram.max / 1000.0, 0, 'f', 1);
+    }
+    return result;
+}
+
+QString PaintProfiler::dump() const
+{
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+        + QStringLiteral("/materialdecoration-stats-%1.txt").arg(QCoreApplication::applicationPid());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    file.write(report().toUtf8());
+    return file.commit() ? path : QString();
+}
+
+void PaintProfiler::reset()
+{
+    m_stages = {};
+}
+
+} // namespace Material
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QVarLengthArray>
+
+// std
+#include <array>
+
+namespace Material
+{
+
+/**
+ * Opt-in timing of the decoration's hot paths.
+ *
+ * Enabled by setting MATERIAL_DECORATION_PROFILE in the environment of
+ * KWin. The statistics of every stage (count, p50, p99, max) are then
+ * available on the org.kde.materialdecoration.Stats interface at
+ * /MaterialDecoration/Stats on the KWin session bus connection, e.g.
+ *
+ *     qdbus org.kde.KWin /MaterialDecoration/Stats report
+ *
+ * When disabled, a ProfileScope costs a single branch.
+ **/
+class PaintProfiler : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.materialdecoration.Stats")
+
+public:
+    enum Stage {
+        Paint,
+        FrameBackground,
+        TitleBarBackground,
+        Buttons,
+        Caption,
+        UpdateShadow,
+        ButtonsGeometry,
+        StageCount
+    };
+
+    static bool isEnabled()
+    {
+        static const bool s_enabled = qEnvironmentVariableIsSet("MATERIAL_DECORATION_PROFILE");
+        return s_enabled;
+    }
+
+    static PaintProfiler *self();
+
+    void record(Stage stage, qint64 nsecs);
+
+public Q_SLOTS:
+    /**
+     * One line per stage, times in microseconds.
+     **/
+    Q_SCRIPTABLE QString report() const;
+
+    /**
+     * Write report() to a file in the temporary directory and return its path.
+     **/
+    Q_SCRIPTABLE QString dump() const;
+
+    Q_SCRIPTABLE void reset();
+
+private:
+    PaintProfiler();
+
+    // Percentiles are taken over the most recent samples only, which is
+    // what matters when looking for the cause of current frame drops.
+    static constexpr int s_window = 1024;
+
+    struct Histogram {
+        quint64 count = 0;
+        qint64 max = 0;
+        std::array<qint64, s_window> samples = {};
+    };
+
+    std::array<Histogram, StageCount> m_stages;
+};
+
+/**
+ * Time the enclosing scope as @p stage, if the profiler is enabled.
+ **/
+class ProfileScope
+{
+public:
+    explicit ProfileScope(PaintProfiler::Stage stage)
+        : m_stage(stage)
+    {
+        if (PaintProfiler::isEnabled()) {
+            m_timer.start();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (m_timer.isValid()) {
+            PaintProfiler::self()->record(m_stage, m_timer.nsecsElapsed());
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    PaintProfiler::Stage m_stage;
+    QElapsedTimer m_timer;
+};
+
+} // namespace Material
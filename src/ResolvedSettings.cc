@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ResolvedSettings.h"
+
+#include <QtGlobal>
+
+namespace Material
+{
+
+ResolvedSettings ResolvedSettings::fromInternalSettings(const InternalSettings &settings)
+{
+    auto int16 = [](int value) {
+        return static_cast<qint16>(qBound(-0x8000, value, 0x7fff));
+    };
+    auto uint16 = [](int value) {
+        return static_cast<quint16>(qBound(0, value, 0xffff));
+    };
+
+    ResolvedSettings resolved;
+    resolved.activeBorderColor = settings.activeBorderColor().rgba();
+    resolved.inactiveBorderColor = settings.inactiveBorderColor().rgba();
+    resolved.shadowColor = settings.shadowColor().rgba();
+    resolved.activeOpacity = settings.activeOpacity();
+    resolved.inactiveOpacity = settings.inactiveOpacity();
+
+    resolved.cornerRadius = int16(settings.cornerRadius());
+    resolved.minWidthForCaption = int16(settings.minWidthForCaption());
+    resolved.menuButtonHorzPadding = int16(settings.menuButtonHorzPadding());
+    resolved.shadowStrength = int16(settings.shadowStrength());
+    resolved.animationsDuration = uint16(settings.animationsDuration());
+    resolved.longPressDuration = uint16(settings.longPressDuration());
+
+    resolved.titleAlignment = settings.titleAlignment();
+    resolved.buttonSize = settings.buttonSize();
+    resolved.shadowSize = settings.shadowSize();
+
+    resolved.bottomCornerRadiusFlag = settings.bottomCornerRadiusFlag();
+    resolved.outlineActive = settings.outlineActive();
+    resolved.useSystemColors = settings.useSystemColors();
+    resolved.useCustomBorderColors = settings.useCustomBorderColors();
+    resolved.hideCaptionWhenLimitedSpace = settings.hideCaptionWhenLimitedSpace();
+    resolved.showCaptionOnHover = settings.showCaptionOnHover();
+    resolved.menuAlwaysShow = settings.menuAlwaysShow();
+    resolved.searchEnabled = settings.searchEnabled();
+    resolved.hamburgerMenu = settings.hamburgerMenu();
+    resolved.showDisabledActions = settings.showDisabledActions();
+    resolved.searchIgnoreTopLevel = settings.searchIgnoreTopLevel();
+    resolved.searchIgnoreSubMenus = settings.searchIgnoreSubMenus();
+    resolved.searchFuzzyMatching = settings.searchFuzzyMatching();
+    resolved.useSystemMenuFont = settings.useSystemMenuFont();
+    resolved.animationsEnabled = settings.animationsEnabled();
+    resolved.longPressEnabled = settings.longPressEnabled();
+    resolved.dragFromButtonsEnabled = settings.dragFromButtonsEnabled();
+    resolved.hideTitleBar = settings.hideTitleBar();
+    resolved.hideApplicationMenu = settings.hideApplicationMenu();
+    resolved.squareCorners = settings.squareCorners();
+    resolved.hideShadow = settings.hideShadow();
+    return resolved;
+}
+
+int diffResolvedSettings(const ResolvedSettingsPtr &a, const ResolvedSettingsPtr &b)
+{
+    if (a == b) {
+        return 0;
+    }
+    if (!a || !b) {
+        return SettingsChange::All;
+    }
+
+    int changes = 0;
+    auto check = [&changes](bool differs, SettingsChange::Flag flag) {
+        if (differs) {
+            changes |= flag;
+        }
+    };
+
+    check(a->activeOpacity != b->activeOpacity, SettingsChange::Colors);
+    check(a->inactiveOpacity != b->inactiveOpacity, SettingsChange::Colors);
+    check(a->useSystemColors != b->useSystemColors, SettingsChange::Colors);
+    check(a->useCustomBorderColors != b->useCustomBorderColors, SettingsChange::Colors);
+    check(a->activeBorderColor != b->activeBorderColor, SettingsChange::Colors);
+    check(a->inactiveBorderColor != b->inactiveBorderColor, SettingsChange::Colors);
+
+    check(a->buttonSize != b->buttonSize, SettingsChange::Frame);
+    check(a->cornerRadius != b->cornerRadius, SettingsChange::Frame);
+    check(a->bottomCornerRadiusFlag != b->bottomCornerRadiusFlag, SettingsChange::Frame);
+    check(a->outlineActive != b->outlineActive, SettingsChange::Frame);
+    check(a->squareCorners != b->squareCorners, SettingsChange::Frame);
+    check(a->hideTitleBar != b->hideTitleBar, SettingsChange::Frame);
+
+    check(a->shadowSize != b->shadowSize, SettingsChange::Shadow);
+    check(a->shadowColor != b->shadowColor, SettingsChange::Shadow);
+    check(a->shadowStrength != b->shadowStrength, SettingsChange::Shadow);
+    check(a->hideShadow != b->hideShadow, SettingsChange::Shadow);
+
+    check(a->titleAlignment != b->titleAlignment, SettingsChange::Caption);
+    check(a->hideCaptionWhenLimitedSpace != b->hideCaptionWhenLimitedSpace, SettingsChange::Caption);
+    check(a->showCaptionOnHover != b->showCaptionOnHover, SettingsChange::Caption);
+    check(a->minWidthForCaption != b->minWidthForCaption, SettingsChange::Caption);
+
+    check(a->menuAlwaysShow != b->menuAlwaysShow, SettingsChange::Menu);
+    check(a->searchEnabled != b->searchEnabled, SettingsChange::Menu);
+    check(a->hamburgerMenu != b->hamburgerMenu, SettingsChange::Menu);
+    check(a->showDisabledActions != b->showDisabledActions, SettingsChange::Menu);
+    check(a->searchIgnoreTopLevel != b->searchIgnoreTopLevel, SettingsChange::Menu);
+    check(a->searchIgnoreSubMenus != b->searchIgnoreSubMenus, SettingsChange::Menu);
+    check(a->searchFuzzyMatching != b->searchFuzzyMatching, SettingsChange::Menu);
+    check(a->menuButtonHorzPadding != b->menuButtonHorzPadding, SettingsChange::Menu);
+    check(a->useSystemMenuFont != b->useSystemMenuFont, SettingsChange::Menu);
+    check(a->hideApplicationMenu != b->hideApplicationMenu, SettingsChange::Menu);
+
+    check(a->animationsEnabled != b->animationsEnabled, SettingsChange::Animation);
+    check(a->animationsDuration != b->animationsDuration, SettingsChange::Animation);
+
+    check(a->longPressEnabled != b->longPressEnabled, SettingsChange::Behavior);
+    check(a->longPressDuration != b->longPressDuration, SettingsChange::Behavior);
+    check(a->dragFromButtonsEnabled != b->dragFromButtonsEnabled, SettingsChange::Behavior);
+
+    return changes;
+}
+
+} // namespace Material
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "InternalSettings.h"
+
+#include <QRgb>
+
+#include <memory>
+#include <type_traits>
+
+namespace Material
+{
+
+// What a decoration has to redo after a settings change.
+namespace SettingsChange
+{
+enum Flag {
+    Colors = 1 << 0,
+    Frame = 1 << 1, // borders, corners, title bar size
+    Shadow = 1 << 2,
+    Caption = 1 << 3,
+    Menu = 1 << 4,
+    Animation = 1 << 5,
+    Behavior = 1 << 6, // read when used, nothing to redo
+    ButtonLayout = 1 << 7, // button order of the window manager
+    All = (1 << 8) - 1,
+};
+}
+
+/**
+ * The settings a decoration reads, once the exception that matches its
+ * window has been applied to the defaults.
+ *
+ * Snapshots are built by SettingsProvider when the configuration is read
+ * and never change afterwards. Windows that resolve to the same values
+ * share one snapshot.
+ **/
+struct ResolvedSettings {
+    static ResolvedSettings fromInternalSettings(const InternalSettings &settings);
+
+    bool operator==(const ResolvedSettings &other) const = default;
+
+    QRgb activeBorderColor = 0;
+    QRgb inactiveBorderColor = 0;
+    QRgb shadowColor = 0;
+    float activeOpacity = 1.0f;
+    float inactiveOpacity = 1.0f;
+
+    qint16 cornerRadius = 0;
+    qint16 minWidthForCaption = 0;
+    qint16 menuButtonHorzPadding = 0;
+    qint16 shadowStrength = 0;
+    quint16 animationsDuration = 0;
+    quint16 longPressDuration = 0;
+
+    // InternalSettings enums
+    quint8 titleAlignment : 3 = InternalSettings::AlignCenter;
+    quint8 buttonSize : 3 = InternalSettings::ButtonDefault;
+    quint8 shadowSize : 3 = InternalSettings::ShadowNone;
+
+    bool bottomCornerRadiusFlag : 1 = false;
+    bool outlineActive : 1 = false;
+    bool useSystemColors : 1 = false;
+    bool useCustomBorderColors : 1 = false;
+    bool hideCaptionWhenLimitedSpace : 1 = false;
+    bool showCaptionOnHover : 1 = false;
+    bool menuAlwaysShow : 1 = false;
+    bool searchEnabled : 1 = false;
+    bool hamburgerMenu : 1 = false;
+    bool showDisabledActions : 1 = false;
+    bool searchIgnoreTopLevel : 1 = false;
+    bool searchIgnoreSubMenus : 1 = false;
+    bool searchFuzzyMatching : 1 = false;
+    bool useSystemMenuFont : 1 = false;
+    bool animationsEnabled : 1 = false;
+    bool longPressEnabled : 1 = false;
+    bool dragFromButtonsEnabled : 1 = false;
+    bool hideTitleBar : 1 = false;
+    bool hideApplicationMenu : 1 = false;
+    bool squareCorners : 1 = false;
+    bool hideShadow : 1 = false;
+};
+
+static_assert(std::is_trivially_copyable_v<ResolvedSettings>);
+
+using ResolvedSettingsPtr = std::shared_ptr<const ResolvedSettings>;
+
+/**
+ * Compare two snapshots field by field and return the SettingsChange flags
+ * of those that differ. Interned snapshots compare by pointer first.
+ **/
+int diffResolvedSettings(const ResolvedSettingsPtr &a, const ResolvedSettingsPtr &b);
+
+} // namespace Material
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// own
+#include "SettingsDispatcher.h"
+#include "Decoration.h"
+#include "Material.h"
+#include "SettingsProvider.h"
+#include "TextWidthCache.h"
+#include "Tracer.h"
+
+// KDecoration
+#include <KDecoration3/DecorationSettings>
+
+// Qt
+#include <QDebug>
+
+// std
+#include <utility>
+
+namespace Material
+{
+
+SettingsDispatcher *SettingsDispatcher::self()
+{
+    static SettingsDispatcher s_self;
+    return &s_self;
+}
+
+SettingsDispatcher::SettingsDispatcher()
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &SettingsDispatcher::flush);
+
+    connect(SettingsProvider::self(), &SettingsProvider::configChanged, this, [this] {
+        ++m_events;
+        m_handlerCalls += m_decorations.size();
+        m_configPending = true;
+        m_timer.start();
+    });
+}
+
+void SettingsDispatcher::add(Decoration *decoration)
+{
+    if (m_decorations.contains(decoration)) {
+        return;
+    }
+    m_decorations.append(decoration);
+    watch(decoration->settings().get());
+}
+
+void SettingsDispatcher::remove(Decoration *decoration)
+{
+    if (!m_decorations.removeOne(decoration)) {
+        return;
+    }
+
+    auto *settings = decoration->settings().get();
+    auto it = m_watched.find(settings);
+    if (it != m_watched.end() && --*it == 0) {
+        disconnect(settings, nullptr, this, nullptr);
+        disconnect(settings, &KDecoration3::DecorationSettings::reconfigured,
+                   SettingsProvider::self(), &SettingsProvider::reconfigure);
+        m_watched.erase(it);
+        m_pending.remove(settings);
+    }
+}
+
+void SettingsDispatcher::watch(KDecoration3::DecorationSettings *settings)
+{
+    if (m_watched[settings]++ > 0) {
+        return;
+    }
+
+    using KDecoration3::DecorationSettings;
+
+    // The KCM preview changes these without touching our configuration
+    // file, so they are not only a matter for KWin's own settings object.
+    // Not made to us, so remove() drops it separately.
+    connect(settings, &DecorationSettings::reconfigured,
+            SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection);
+    connect(settings, &DecorationSettings::alphaChannelSupportedChanged, this, [this, settings] {
+        post(settings, SettingsChange::All);
+    });
+    connect(settings, &DecorationSettings::borderSizeChanged, this, [this, settings] {
+        post(settings, SettingsChange::Frame);
+    });
+    connect(settings, &DecorationSettings::fontChanged, this, [this, settings] {
+        m_fontPending = true;
+        post(settings, SettingsChange::Frame | SettingsChange::Caption, 2);
+    });
+    connect(settings, &DecorationSettings::spacingChanged, this, [this, settings] {
+        post(settings, SettingsChange::Frame);
+    });
+    connect(settings, &DecorationSettings::decorationButtonsLeftChanged, this, [this, settings] {
+        post(settings, SettingsChange::ButtonLayout);
+    });
+    connect(settings, &DecorationSettings::decorationButtonsRightChanged, this, [this, settings] {
+        post(settings, SettingsChange::ButtonLayout);
+    });
+}
+
+void SettingsDispatcher::post(KDecoration3::DecorationSettings *settings, int changes, int handlers)
+{
+    ++m_events;
+    m_handlerCalls += quint64(m_watched.value(settings)) * handlers;
+    m_pending[settings] |= changes;
+    m_timer.start();
+}
+
+void SettingsDispatcher::flush()
+{
+    const TraceScope trace("SettingsDispatcher::flush");
+
+    if (m_fontPending) {
+        TextWidthCache::self()->clear();
+    }
+
+    const auto pending = std::exchange(m_pending, {});
+    const bool configPending = std::exchange(m_configPending, false);
+    m_fontPending = false;
+
+    // Updating a decoration must not add or remove others, but stay safe
+    // if it does.
+    const QList<Decoration *> decorations = m_decorations;
+    for (Decoration *decoration : decorations) {
+        if (!m_decorations.contains(decoration)) {
+            continue;
+        }
+        const int changes = pending.value(decoration->settings().get());
+        if (changes || configPending) {
+            ++m_calls;
+            decoration->onSettingsChanged(changes);
+        }
+    }
+
+    qCDebug(category) << "Settings dispatch:" << m_events << "events," << m_calls << "decoration updates,"
+                      << m_handlerCalls - qMin(m_handlerCalls, m_calls) << "handler calls avoided";
+}
+
+} // namespace Material
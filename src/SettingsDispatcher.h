@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+// Qt
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+namespace KDecoration3
+{
+class DecorationSettings;
+}
+
+namespace Material
+{
+
+class Decoration;
+
+/**
+ * Single listener for everything that changes the settings of all
+ * decorations at once: our own configuration and the DecorationSettings
+ * of KWin (or of the KCM preview).
+ *
+ * A theme change emits several of these signals in a row. They are
+ * collected until the event loop is idle, then every affected decoration
+ * is updated once with the union of the SettingsChange flags.
+ **/
+class SettingsDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SettingsDispatcher *self();
+
+    SettingsDispatcher();
+
+    void add(Decoration *decoration);
+    void remove(Decoration *decoration);
+
+private:
+    void watch(KDecoration3::DecorationSettings *settings);
+    // @p handlers is how many slots each decoration used to have on the signal.
+    void post(KDecoration3::DecorationSettings *settings, int changes, int handlers = 1);
+    void flush();
+
+    QList<Decoration *> m_decorations;
+    QHash<KDecoration3::DecorationSettings *, int> m_watched; // decorations using it
+
+    QTimer m_timer;
+    QHash<KDecoration3::DecorationSettings *, int> m_pending;
+    bool m_configPending = false;
+    bool m_fontPending = false;
+
+    quint64 m_events = 0;
+    quint64 m_calls = 0;
+    quint64 m_handlerCalls = 0; // what the per-decoration connections would have made
+};
+
+} // namespace Material
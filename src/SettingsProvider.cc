@@ -17,11 +17,15 @@
 
 #include "SettingsProvider.h"
 #include "Decoration.h"
+#include "Material.h"
 
 #include <KDecoration3/DecoratedWindow>
 #include <QDBusConnection>
 #include <QDBusMessage>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStandardPaths>
 
 namespace Material
 {
@@ -47,130 +51,208 @@ SettingsProvider::SettingsProvider()
 
 void SettingsProvider::reconfigure()
 {
-    m_defaultSettings = InternalSettingsPtr(new InternalSettings());
-    m_defaultSettings->load();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Most notifyChange broadcasts are about other settings and leave our
+    // file alone. Color scheme changes among them are picked up by each
+    // decoration from DecoratedWindow::paletteChanged.
+    const QFileInfo info(QStandardPaths::locate(QStandardPaths::GenericConfigLocation, s_configFilename));
+    const ConfigStamp stamp{info.filePath(), info.lastModified(), info.size()};
+    if (m_defaultSettings && stamp == m_configStamp) {
+        qCDebug(category) << "Settings file unchanged, reconfigure took" << timer.nsecsElapsed() / 1000 << "µs";
+        return;
+    }
+    m_configStamp = stamp;
 
-    auto config = KSharedConfig::openConfig(QStringLiteral("kdecoration_materialrc"));
-    config->reparseConfiguration();
-    m_exceptions.readConfig(config);
+    // Only the defaults need the whole schema, the exceptions are read
+    // field by field.
+    m_config.load();
+    const ResolvedSettings defaults = ResolvedSettings::fromInternalSettings(m_config);
 
-    m_compiledExceptions.clear();
+    QList<ExceptionMatcher::Rule> rules;
+    QList<ResolvedSettings> exceptionSettings;
 
-    for (const auto &exceptionSettings : m_exceptions.exceptions()) {
-        if (!exceptionSettings->enabled()) {
+    for (const ExceptionEntry &exception : readExceptionEntries(m_config.sharedConfig())) {
+        if (!exception.enabled) {
             continue;
         }
 
-        CompiledException compiled;
-        compiled.type = static_cast<ExceptionType>(exceptionSettings->exceptionType());
-        compiled.matchingMode = static_cast<MatchingMode>(exceptionSettings->matchingMode());
-        compiled.pattern = exceptionSettings->exceptionPattern().trimmed();
-        compiled.enabled = exceptionSettings->enabled();
+        ExceptionMatcher::Rule rule;
+        rule.type = exception.type;
+        rule.matchingMode = exception.matchingMode;
+        rule.pattern = exception.pattern.trimmed();
 
-        if (compiled.pattern.isEmpty()) {
+        if (rule.pattern.isEmpty()) {
             continue;
         }
 
-        if (compiled.matchingMode == MatchingMode::RegularExpression) {
-            QRegularExpression regex(compiled.pattern, QRegularExpression::CaseInsensitiveOption);
+        if (rule.matchingMode == MatchingMode::RegularExpression) {
+            const QRegularExpression regex(rule.pattern, QRegularExpression::CaseInsensitiveOption);
             if (!regex.isValid()) {
-                qWarning() << "Invalid exception regular expression pattern:" << compiled.pattern << regex.errorString();
+                qWarning() << "Invalid exception regular expression pattern:" << rule.pattern << regex.errorString();
                 continue;
             }
-            compiled.regex = regex;
         }
 
-        compiled.mergedSettings = createMergedSettings(m_defaultSettings, exceptionSettings);
-        m_compiledExceptions.append(compiled);
+        rules.append(rule);
+        exceptionSettings.append(createMergedSettings(defaults, exception));
+    }
+
+    QList<ResolvedSettingsPtr> snapshots;
+    const ResolvedSettingsPtr defaultSettings = intern(defaults, snapshots);
+    QList<ResolvedSettingsPtr> exceptionSnapshots;
+    exceptionSnapshots.reserve(exceptionSettings.size());
+    for (const ResolvedSettings &settings : std::as_const(exceptionSettings)) {
+        exceptionSnapshots.append(intern(settings, snapshots));
+    }
+
+    // Unchanged values got their old snapshots back, so comparing the
+    // pointers is enough to know whether the decorations need to hear
+    // about it.
+    if (rules == m_rules && defaultSettings == m_defaultSettings && exceptionSnapshots == m_exceptionSettings) {
+        qCDebug(category) << "Settings unchanged, reconfigure took" << timer.nsecsElapsed() / 1000 << "µs";
+        return;
     }
 
+    m_defaultSettings = defaultSettings;
+    m_exceptionSettings = exceptionSnapshots;
+    m_snapshots = snapshots;
+    if (rules != m_rules) {
+        m_rules = rules;
+        m_matcher.compile(m_rules);
+    }
+    ++m_generation;
+    m_classResults.clear();
+
+    qCDebug(category) << "Settings changed, reconfigure took" << timer.nsecsElapsed() / 1000 << "µs |"
+                      << m_rules.size() << "rules share" << m_snapshots.size() << "snapshots of"
+                      << sizeof(ResolvedSettings) << "bytes";
     emit configChanged();
 }
 
-InternalSettingsPtr SettingsProvider::createMergedSettings(const InternalSettingsPtr &defaultSettings,
-                                                             const InternalSettingsPtr &exceptionSettings)
+ResolvedSettingsPtr SettingsProvider::intern(const ResolvedSettings &settings, QList<ResolvedSettingsPtr> &snapshots) const
 {
-    InternalSettingsPtr merged(new InternalSettings());
-    copyInternalSettings(defaultSettings, merged);
+    // There are never more snapshots than rules, a linear search is fine.
+    auto find = [&settings](const QList<ResolvedSettingsPtr> &list) -> ResolvedSettingsPtr {
+        for (const ResolvedSettingsPtr &snapshot : list) {
+            if (*snapshot == settings) {
+                return snapshot;
+            }
+        }
+        return nullptr;
+    };
 
-    const int mask = exceptionSettings->mask();
+    if (ResolvedSettingsPtr snapshot = find(snapshots)) {
+        return snapshot;
+    }
+
+    // Reuse the previous snapshot when the value is unchanged, so the
+    // decorations holding it can tell by the pointer.
+    ResolvedSettingsPtr snapshot = find(m_snapshots);
+    if (!snapshot) {
+        snapshot = std::make_shared<const ResolvedSettings>(settings);
+    }
+    snapshots.append(snapshot);
+    return snapshot;
+}
+
+ResolvedSettings SettingsProvider::createMergedSettings(const ResolvedSettings &defaultSettings,
+                                                        const ExceptionEntry &exception)
+{
+    ResolvedSettings merged = defaultSettings;
+
+    const int mask = exception.mask;
 
     if (mask & ExceptionMask::HideTitleBar) {
-        merged->setHideTitleBar(exceptionSettings->hideTitleBar());
+        merged.hideTitleBar = exception.hideTitleBar;
     }
 
     if (mask & ExceptionMask::HideApplicationMenu) {
-        merged->setHideApplicationMenu(exceptionSettings->hideApplicationMenu());
-        if (exceptionSettings->hideApplicationMenu()) {
-            merged->setMenuAlwaysShow(false);
+        merged.hideApplicationMenu = exception.hideApplicationMenu;
+        if (exception.hideApplicationMenu) {
+            merged.menuAlwaysShow = false;
         }
     }
 
     if (mask & ExceptionMask::HamburgerMenu) {
-        merged->setHamburgerMenu(exceptionSettings->hamburgerMenu());
+        merged.hamburgerMenu = exception.hamburgerMenu;
     }
 
     if (mask & ExceptionMask::HideShadow) {
-        merged->setHideShadow(exceptionSettings->hideShadow());
-        if (exceptionSettings->hideShadow()) {
-            merged->setShadowSize(InternalSettings::ShadowNone);
+        merged.hideShadow = exception.hideShadow;
+        if (exception.hideShadow) {
+            merged.shadowSize = InternalSettings::ShadowNone;
         }
     }
 
     if (mask & ExceptionMask::SquareCorners) {
-        merged->setSquareCorners(exceptionSettings->squareCorners());
-        if (exceptionSettings->squareCorners()) {
-            merged->setCornerRadius(0);
+        merged.squareCorners = exception.squareCorners;
+        if (exception.squareCorners) {
+            merged.cornerRadius = 0;
         }
     }
 
     if (mask & ExceptionMask::OutlineActive) {
-        merged->setOutlineActive(exceptionSettings->outlineActive());
+        merged.outlineActive = exception.outlineActive;
     }
 
     return merged;
 }
 
-InternalSettingsPtr SettingsProvider::internalSettings(Decoration *decoration)
+ResolvedSettingsPtr SettingsProvider::internalSettings(Decoration *decoration)
 {
     if (!decoration || !decoration->window()) {
         return m_defaultSettings;
     }
 
-    const QString caption = decoration->window()->caption();
     const QString windowClass = decoration->window()->windowClass();
-
-    for (const auto &compiled : m_compiledExceptions) {
-        if (!compiled.enabled || compiled.pattern.isEmpty()) {
-            continue;
+    if (!m_matcher.hasTitleRules()) {
+        auto it = m_classResults.constFind(windowClass);
+        if (it != m_classResults.cend()) {
+            countEvaluation(true);
+            return *it;
         }
+    }
 
-        const QString valueToMatch = (compiled.type == ExceptionType::WindowTitle) ? caption : windowClass;
-        bool matches = false;
-
-        if (compiled.matchingMode == MatchingMode::ExactMatch) {
-            if (valueToMatch.compare(compiled.pattern, Qt::CaseInsensitive) == 0) {
-                matches = true;
-            } else if (compiled.type == ExceptionType::WindowClass) { // Window Class component match
-                static const QRegularExpression splitRegex(QStringLiteral("[\\s\\r\\n\\t\\x00]+"));
-                const QStringList components = valueToMatch.split(splitRegex, Qt::SkipEmptyParts);
-                for (const QString &comp : components) {
-                    if (comp.compare(compiled.pattern, Qt::CaseInsensitive) == 0) {
-                        matches = true;
-                        break;
-                    }
-                }
-            }
-        } else if (compiled.matchingMode == MatchingMode::RegularExpression) {
-            matches = compiled.regex.match(valueToMatch).hasMatch();
-        }
+    countEvaluation(false);
+    const int rule = m_matcher.match(decoration->window()->caption(), windowClass);
+    const ResolvedSettingsPtr settings = rule >= 0 ? m_exceptionSettings.at(rule) : m_defaultSettings;
+    if (!m_matcher.hasTitleRules()) {
+        m_classResults.insert(windowClass, settings);
+    }
+    return settings;
+}
 
-        if (matches) {
-            return compiled.mergedSettings;
-        }
+ResolvedSettingsPtr SettingsProvider::internalSettings(Decoration *decoration, Resolution &resolution)
+{
+    if (!decoration || !decoration->window()) {
+        return m_defaultSettings;
+    }
+
+    const auto *window = decoration->window();
+    if (resolution.generation == m_generation && resolution.windowClass == window->windowClass()
+        && (!m_matcher.hasTitleRules() || resolution.caption == window->caption())) {
+        countEvaluation(true);
+        return resolution.settings;
     }
 
-    return m_defaultSettings;
+    resolution.settings = internalSettings(decoration);
+    resolution.generation = m_generation;
+    resolution.windowClass = window->windowClass();
+    resolution.caption = m_matcher.hasTitleRules() ? window->caption() : QString();
+    return resolution.settings;
+}
+
+void SettingsProvider::countEvaluation(bool avoided)
+{
+    if (avoided) {
+        ++m_avoided;
+    } else if (++m_evaluations % 256 == 0) {
+        qCDebug(category) << "Exception rules: evaluated" << m_evaluations
+                          << "avoided" << m_avoided
+                          << "| title rules" << m_matcher.hasTitleRules();
+    }
 }
 
 } // namespace Material
@@ -18,11 +18,12 @@
 #pragma once
 
 #include "ExceptionList.h"
+#include "ExceptionMatcher.h"
 #include "InternalSettings.h"
+#include "ResolvedSettings.h"
 
+#include <QDateTime>
 #include <QObject>
-#include <QRegularExpression>
-#include <QSharedPointer>
 
 namespace Material
 {
@@ -39,10 +40,28 @@ public:
     SettingsProvider();
     ~SettingsProvider() override = default;
 
-    InternalSettingsPtr internalSettings(Decoration *decoration);
+    ResolvedSettingsPtr internalSettings(Decoration *decoration);
 
-    InternalSettingsPtr createMergedSettings(const InternalSettingsPtr &defaultSettings,
-                                              const InternalSettingsPtr &exceptionSettings);
+    /**
+     * The last resolution for one window, kept by its decoration.
+     **/
+    struct Resolution {
+        quint64 generation = 0;
+        QString caption;
+        QString windowClass;
+        ResolvedSettingsPtr settings;
+    };
+
+    /**
+     * Same as internalSettings(), but returns the result in @p resolution
+     * again as long as neither the configuration nor anything the rules
+     * look at has changed since. Without title rules that is only the
+     * window class, so caption changes never cause a new evaluation.
+     **/
+    ResolvedSettingsPtr internalSettings(Decoration *decoration, Resolution &resolution);
+
+    static ResolvedSettings createMergedSettings(const ResolvedSettings &defaultSettings,
+                                                 const ExceptionEntry &exception);
 
 public slots:
     void reconfigure();
@@ -51,18 +70,33 @@ signals:
     void configChanged();
 
 private:
-    struct CompiledException {
-        InternalSettingsPtr mergedSettings;
-        QRegularExpression regex;
-        QString pattern;
-        ExceptionType type = ExceptionType::WindowTitle;
-        MatchingMode matchingMode = MatchingMode::ExactMatch;
-        bool enabled = true;
+    ResolvedSettingsPtr intern(const ResolvedSettings &settings, QList<ResolvedSettingsPtr> &snapshots) const;
+
+    InternalSettings m_config;
+    ResolvedSettingsPtr m_defaultSettings;
+    // Merged settings of each rule of m_matcher, by rule index.
+    QList<ResolvedSettingsPtr> m_exceptionSettings;
+    // Every distinct snapshot in use, each one only once.
+    QList<ResolvedSettingsPtr> m_snapshots;
+    QList<ExceptionMatcher::Rule> m_rules;
+    ExceptionMatcher m_matcher;
+
+    struct ConfigStamp {
+        QString path;
+        QDateTime modified;
+        qint64 size = -1;
+
+        bool operator==(const ConfigStamp &other) const = default;
     };
+    ConfigStamp m_configStamp;
+
+    quint64 m_generation = 0; // Bumped by reconfigure()
+    // Only used when there are no title rules.
+    QHash<QString, ResolvedSettingsPtr> m_classResults;
 
-    InternalSettingsPtr m_defaultSettings;
-    ExceptionList m_exceptions;
-    QList<CompiledException> m_compiledExceptions;
+    void countEvaluation(bool avoided);
+    quint64 m_evaluations = 0;
+    quint64 m_avoided = 0;
 };
 
 } // namespace Material
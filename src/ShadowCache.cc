@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "ShadowCache.h"
+#include "Material.h"
+
+// KDecoration
+#include <KDecoration3/DecorationShadow>
+
+// Qt
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace Material
+{
+
+ShadowCache *ShadowCache::self()
+{
+    static ShadowCache s_self;
+    return &s_self;
+}
+
+ShadowCache::~ShadowCache()
+{
+    clear();
+}
+
+ShadowCache::ShadowPtr ShadowCache::find(const ShadowKey &key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+
+    ++m_hits;
+    it->lastUsed = ++m_clock;
+    return it->shadow;
+}
+
+ShadowCache::ShadowPtr ShadowCache::nearest(const ShadowKey &key) const
+{
+    // A wrong size is more noticeable than a wrong color.
+    auto distance = [&key](const ShadowKey &other) {
+        return (other.sizePreset != key.sizePreset) * 4
+            + (other.cornerRadius != key.cornerRadius) * 2
+            + (other.color != key.color || other.strength != key.strength);
+    };
+
+    ShadowPtr best;
+    int bestDistance = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        const int d = distance(it.key());
+        if (!best || d < bestDistance) {
+            best = it->shadow;
+            bestDistance = d;
+        }
+    }
+    return best;
+}
+
+void ShadowCache::request(const ShadowKey &key, Generator generator)
+{
+    if (m_pending.contains(key)) {
+        return;
+    }
+
+    ++m_misses;
+
+    auto *watcher = new QFutureWatcher<ShadowTexture>(this);
+    connect(watcher, &QFutureWatcher<ShadowTexture>::finished, this, [this, key, watcher] {
+        m_pending.remove(key);
+        watcher->deleteLater();
+        finish(key, watcher->result());
+    });
+    m_pending.insert(key, watcher);
+    watcher->setFuture(QtConcurrent::run(generator, key));
+}
+
+void ShadowCache::finish(const ShadowKey &key, const ShadowTexture &texture)
+{
+    if (!texture.image.isNull()) {
+        auto shadow = std::make_shared<KDecoration3::DecorationShadow>();
+        shadow->setPadding(texture.padding);
+        shadow->setInnerShadowRect(texture.innerShadowRect);
+        shadow->setShadow(texture.image);
+        m_entries.insert(key, Entry{shadow, ++m_clock});
+    }
+
+    qCDebug(category) << "Shadow cache miss: preset" << key.sizePreset
+                      << "radius" << key.cornerRadius
+                      << "| entries" << m_entries.size()
+                      << "hits" << m_hits
+                      << "misses" << m_misses;
+
+    emit shadowReady(key);
+
+    // Only now, so that the new entry is already in use by the decorations
+    // that asked for it.
+    evict();
+}
+
+void ShadowCache::clear()
+{
+    for (auto *watcher : std::as_const(m_pending)) {
+        watcher->disconnect(this);
+        watcher->waitForFinished();
+        delete watcher;
+    }
+    m_pending.clear();
+    m_entries.clear();
+}
+
+void ShadowCache::evict()
+{
+    while (m_entries.size() > s_capacity) {
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            // The cache holds one reference; anything above that is a decoration using it.
+            if (it->shadow.use_count() > 1) {
+                continue;
+            }
+            if (victim == m_entries.end() || it->lastUsed < victim->lastUsed) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            // Every entry is in use, dropping one would not free anything.
+            return;
+        }
+        m_entries.erase(victim);
+    }
+}
+
+} // namespace Material
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QColor>
+#include <QHash>
+#include <QHashFunctions>
+#include <QImage>
+#include <QMarginsF>
+#include <QObject>
+#include <QRectF>
+
+// std
+#include <memory>
+
+template<typename T>
+class QFutureWatcher;
+
+namespace KDecoration3
+{
+class DecorationShadow;
+}
+
+namespace Material
+{
+
+/**
+ * Everything that influences the pixels of a shadow texture.
+ *
+ * The output scale is not part of it: BoxShadowRenderer always renders in
+ * logical pixels and KWin scales the texture, so every scale would get a
+ * byte-identical copy.
+ **/
+struct ShadowKey {
+    int sizePreset = 0;
+    QRgb color = 0;
+    int strength = 0;
+    qreal cornerRadius = 0.0;
+
+    bool operator==(const ShadowKey &other) const = default;
+};
+
+inline size_t qHash(const ShadowKey &key, size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, key.sizePreset, key.color, key.strength, key.cornerRadius);
+}
+
+/**
+ * The pixels and geometry of a shadow, as produced on a worker thread.
+ *
+ * KDecoration3::DecorationShadow is a QObject, so it is only created from
+ * this once the texture is back on the GUI thread.
+ **/
+struct ShadowTexture {
+    QImage image;
+    QMarginsF padding;
+    QRectF innerShadowRect;
+};
+
+/**
+ * Process-wide cache of shadow objects.
+ *
+ * Decorations with identical shadow parameters share the same
+ * KDecoration3::DecorationShadow. Entries still referenced by a decoration
+ * are never evicted; unreferenced ones are dropped in least-recently-used
+ * order once the cache grows past its capacity.
+ *
+ * Missing shadows are generated on the global thread pool, so that a
+ * configuration change with many open windows doesn't stall the compositor.
+ **/
+class ShadowCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    using ShadowPtr = std::shared_ptr<KDecoration3::DecorationShadow>;
+    using Generator = ShadowTexture (*)(const ShadowKey &key);
+
+    static ShadowCache *self();
+
+    ShadowCache() = default;
+    ~ShadowCache() override;
+
+    /**
+     * Return the shadow for @p key if it is ready, nullptr otherwise.
+     **/
+    ShadowPtr find(const ShadowKey &key);
+
+    /**
+     * Return the cached shadow that looks the most like the one for @p key,
+     * to be shown while the right one is being generated.
+     **/
+    ShadowPtr nearest(const ShadowKey &key) const;
+
+    /**
+     * Run @p generator for @p key on a worker thread. shadowReady() is
+     * emitted on the GUI thread once the result is in the cache. Requests
+     * for a key that is already being generated are merged.
+     **/
+    void request(const ShadowKey &key, Generator generator);
+
+    void clear();
+
+    int size() const { return m_entries.size(); }
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+
+signals:
+    /**
+     * The shadow for @p key has been generated. find() returns nullptr if
+     * the generator produced nothing.
+     **/
+    void shadowReady(const ShadowKey &key);
+
+private:
+    void finish(const ShadowKey &key, const ShadowTexture &texture);
+    void evict();
+
+    struct Entry {
+        ShadowPtr shadow;
+        quint64 lastUsed = 0;
+    };
+
+    static constexpr int s_capacity = 8;
+
+    QHash<ShadowKey, Entry> m_entries;
+    QHash<ShadowKey, QFutureWatcher<ShadowTexture> *> m_pending;
+    quint64 m_clock = 0;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+} // namespace Material
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "ShadowDiskCache.h"
+#include "Material.h"
+
+// Qt
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// std
+#include <cstring>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Material
+{
+namespace
+{
+
+constexpr char s_magic[4] = {'M', 'D', 'S', 'H'};
+
+// How many textures to keep; every preset and color in use needs one.
+constexpr int s_maxFiles = 32;
+
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 reserved;
+    double padding[4];
+    double innerShadowRect[4];
+};
+static_assert(sizeof(FileHeader) % 8 == 0, "the pixels must stay aligned");
+
+struct Mapping {
+    void *address;
+    size_t length;
+};
+
+bool isEnabled()
+{
+    static const bool enabled = !qEnvironmentVariableIsSet("MATERIAL_DECORATION_NO_SHADOW_DISK_CACHE");
+    return enabled;
+}
+
+QString cacheDirectory()
+{
+    static const QString directory = [] {
+        const QString base = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/materialdecoration");
+        const QString current = QStringLiteral("shadows-v%1").arg(ShadowDiskCache::s_generatorVersion);
+
+        // Textures from other generator versions would never be hit again.
+        QDir baseDir(base);
+        const QStringList entries = baseDir.entryList({QStringLiteral("shadows-v*")}, QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString &entry : entries) {
+            if (entry != current) {
+                QDir(baseDir.filePath(entry)).removeRecursively();
+            }
+        }
+
+        const QString path = baseDir.filePath(current);
+        QDir().mkpath(path);
+        return path;
+    }();
+    return directory;
+}
+
+QString filePath(const QByteArray &id)
+{
+    return cacheDirectory() + QLatin1Char('/') + QString::fromLatin1(id.toHex()) + QStringLiteral(".shadow");
+}
+
+void removeOldestFiles(const QString &directory)
+{
+    const QFileInfoList files = QDir(directory).entryInfoList({QStringLiteral("*.shadow")}, QDir::Files, QDir::Time);
+    for (int i = s_maxFiles; i < files.size(); ++i) {
+        QFile::remove(files.at(i).filePath());
+    }
+}
+
+} // anonymous namespace
+
+ShadowTexture ShadowDiskCache::load(const QByteArray &id)
+{
+    if (!isEnabled()) {
+        return {};
+    }
+
+    const QByteArray path = QFile::encodeName(filePath(id));
+    const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+
+    struct stat info;
+    FileHeader header;
+    const bool valid = ::fstat(fd, &info) == 0
+        && ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+        && std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0
+        && header.version == s_generatorVersion
+        && header.width > 0 && header.height > 0
+        && header.width <= 20000 && header.height <= 20000
+        && header.bytesPerLine >= header.width * 4
+        && info.st_size == static_cast<off_t>(sizeof(header) + static_cast<size_t>(header.bytesPerLine) * header.height);
+    if (!valid) {
+        ::close(fd);
+        return {};
+    }
+
+    const size_t length = info.st_size;
+    void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return {};
+    }
+
+    // The image doesn't own the pixels, so unmap them when it goes away.
+    auto *mapping = new Mapping{address, length};
+    auto cleanup = [](void *info) {
+        auto *mapping = static_cast<Mapping *>(info);
+        ::munmap(mapping->address, mapping->length);
+        delete mapping;
+    };
+
+    const auto *pixels = static_cast<const uchar *>(address) + sizeof(header);
+    ShadowTexture texture;
+    texture.image = QImage(pixels, header.width, header.height, header.bytesPerLine,
+                           QImage::Format_ARGB32_Premultiplied, cleanup, mapping);
+    texture.padding = QMarginsF(header.padding[0], header.padding[1], header.padding[2], header.padding[3]);
+    texture.innerShadowRect = QRectF(header.innerShadowRect[0], header.innerShadowRect[1],
+                                     header.innerShadowRect[2], header.innerShadowRect[3]);
+    return texture;
+}
+
+void ShadowDiskCache::store(const QByteArray &id, const ShadowTexture &texture)
+{
+    if (!isEnabled() || texture.image.format() != QImage::Format_ARGB32_Premultiplied) {
+        return;
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version = s_generatorVersion;
+    header.width = texture.image.width();
+    header.height = texture.image.height();
+    header.bytesPerLine = texture.image.width() * 4;
+    header.padding[0] = texture.padding.left();
+    header.padding[1] = texture.padding.top();
+    header.padding[2] = texture.padding.right();
+    header.padding[3] = texture.padding.bottom();
+    header.innerShadowRect[0] = texture.innerShadowRect.x();
+    header.innerShadowRect[1] = texture.innerShadowRect.y();
+    header.innerShadowRect[2] = texture.innerShadowRect.width();
+    header.innerShadowRect[3] = texture.innerShadowRect.height();
+
+    // Written to a temporary file and renamed, so a reader never sees half a texture.
+    QSaveFile file(filePath(id));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (int y = 0; y < header.height; ++y) {
+        file.write(reinterpret_cast<const char *>(texture.image.constScanLine(y)), header.bytesPerLine);
+    }
+    if (!file.commit()) {
+        qCDebug(category) << "Could not write shadow texture" << file.fileName() << file.errorString();
+        return;
+    }
+
+    removeOldestFiles(cacheDirectory());
+}
+
+} // namespace Material
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// own
+#include "ShadowCache.h"
+
+// Qt
+#include <QByteArray>
+
+namespace Material
+{
+
+/**
+ * Shadow textures kept in $XDG_CACHE_HOME across KWin restarts.
+ *
+ * Every texture is a single file holding a small header and the raw
+ * premultiplied pixels, which are memory-mapped on load, so a hit only
+ * costs a page-in. Files written by another generator version are removed
+ * on first use.
+ *
+ * Both functions are safe to call from worker threads. Setting
+ * MATERIAL_DECORATION_NO_SHADOW_DISK_CACHE in the environment turns the
+ * cache off.
+ **/
+class ShadowDiskCache
+{
+public:
+    /**
+     * Bump this whenever the generated pixels change for the same parameters.
+     **/
+    static constexpr quint32 s_generatorVersion = 1;
+
+    /**
+     * Return the texture stored under @p id, or a null image on a miss.
+     **/
+    static ShadowTexture load(const QByteArray &id);
+
+    static void store(const QByteArray &id, const ShadowTexture &texture);
+};
+
+} // namespace Material
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "TextWidthCache.h"
+#include "Material.h"
+
+// Qt
+#include <QDebug>
+#include <QFontMetricsF>
+#include <QtMath>
+
+namespace Material
+{
+
+TextWidthCache *TextWidthCache::self()
+{
+    static TextWidthCache s_self;
+    return &s_self;
+}
+
+qreal TextWidthCache::width(const QFont &font, const QString &text, bool showMnemonic, qreal scale)
+{
+    const Key key{font, text, showMnemonic, scale};
+    const auto it = m_widths.constFind(key);
+    if (it != m_widths.constEnd()) {
+        ++m_hits;
+        return *it;
+    }
+
+    ++m_misses;
+    const QFontMetricsF fontMetrics(font);
+    const int flags = showMnemonic ? Qt::TextShowMnemonic : Qt::TextHideMnemonic;
+    // Use an unconstrained bounding rect to get the ideal width.
+    const QRectF boundingRect = fontMetrics.boundingRect(QRectF(), flags, text);
+    const qreal width = qCeil(boundingRect.width() * scale) / scale;
+
+    if (m_widths.size() >= s_capacity) {
+        m_widths.clear();
+    }
+    m_widths.insert(key, width);
+
+    if (m_misses % 256 == 0) {
+        qCDebug(category) << "Text width cache: entries" << m_widths.size()
+                          << "hits" << m_hits
+                          << "misses" << m_misses
+                          << "hit rate" << qreal(m_hits) / (m_hits + m_misses);
+    }
+    return width;
+}
+
+void TextWidthCache::clear()
+{
+    if (m_hits || m_misses) {
+        qCDebug(category) << "Text width cache cleared: entries" << m_widths.size()
+                          << "hits" << m_hits
+                          << "misses" << m_misses
+                          << "hit rate" << qreal(m_hits) / (m_hits + m_misses);
+    }
+    m_widths.clear();
+}
+
+} // namespace Material
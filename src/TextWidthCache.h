@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QFont>
+#include <QHash>
+#include <QHashFunctions>
+#include <QString>
+
+namespace Material
+{
+
+/**
+ * Process-wide cache of menu label widths.
+ *
+ * Every decoration of the same application measures the same "File",
+ * "Edit", "View" labels again on each geometry update, so the results
+ * are shared. The cache is cleared when the decoration font changes.
+ **/
+class TextWidthCache
+{
+public:
+    static TextWidthCache *self();
+
+    /**
+     * Return the width of @p text in @p font, rounded up to whole physical
+     * pixels at @p scale.
+     **/
+    qreal width(const QFont &font, const QString &text, bool showMnemonic, qreal scale);
+
+    void clear();
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+
+private:
+    TextWidthCache() = default;
+
+    struct Key {
+        QFont font;
+        QString text;
+        bool showMnemonic = false;
+        qreal scale = 1.0;
+
+        bool operator==(const Key &other) const = default;
+    };
+
+    friend size_t qHash(const Key &key, size_t seed) noexcept
+    {
+        return qHashMulti(seed, key.font, key.text, key.showMnemonic, key.scale);
+    }
+
+    // Labels of a few dozen applications at a couple of scales fit easily.
+    static constexpr int s_capacity = 2048;
+
+    QHash<Key, qreal> m_widths;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+} // namespace Material
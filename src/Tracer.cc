@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// own
+#include "Tracer.h"
+#include "Material.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace Material
+{
+
+Tracer *Tracer::self()
+{
+    static Tracer s_self;
+    return &s_self;
+}
+
+Tracer::Tracer()
+{
+    m_clock.start();
+    m_events.reserve(s_capacity);
+
+    const QString path = QStringLiteral("/MaterialDecoration/Trace");
+    if (!QDBusConnection::sessionBus().registerObject(path, this, QDBusConnection::ExportScriptableSlots)) {
+        qCDebug(category) << "Tracer: could not register" << path << "on the session bus";
+    }
+
+    // Write the buffer while the application is still fully alive, rather
+    // than from the static destructor after QCoreApplication is gone.
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &Tracer::dump);
+    }
+}
+
+Tracer::~Tracer() = default;
+
+void Tracer::record(const char *name, char phase)
+{
+    const Event event{name,
+                      m_clock.nsecsElapsed(),
+                      quint64(reinterpret_cast<quintptr>(QThread::currentThreadId())),
+                      phase};
+
+    const QMutexLocker locker(&m_mutex);
+    if (m_events.size() < s_capacity) {
+        m_events.push_back(event);
+    } else {
+        m_events[m_next] = event;
+        m_next = (m_next + 1) % s_capacity;
+    }
+}
+
+QString Tracer::dump()
+{
+    QString path = qEnvironmentVariable("MATERIAL_DECORATION_TRACE");
+    if (path.isEmpty() || path == QLatin1String("1")) {
+        path = QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+            + QStringLiteral("/materialdecoration-trace-%1.json").arg(QCoreApplication::applicationPid());
+    }
+
+    QByteArray json;
+    {
+        const QMutexLocker locker(&m_mutex);
+        json.reserve(m_events.size() * 96);
+        json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+        for (size_t i = 0; i < m_events.size(); ++i) {
+            // Oldest first.
+            const Event &event = m_events[(m_next + i) % m_events.size()];
+            if (i > 0) {
+                json += ',';
+            }
+            json += "\n{\"name\":\"";
+            json += event.name;
+            json += "\",\"ph\":\"";
+            json += event.phase;
+            json += "\",\"ts\":";
+            json += QByteArray::number(event.timestamp / 1000.0, 'f', 3);
+            json += ",\"pid\":";
+            json += pid;
+            json += ",\"tid\":";
+            json += QByteArray::number(event.thread);
+            json += '}';
+        }
+        json += "\n]}\n";
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        qCDebug(category) << "Tracer: could not write" << path;
+        return QString();
+    }
+    return path;
+}
+
+void Tracer::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_events.clear();
+    m_next = 0;
+}
+
+} // namespace Material
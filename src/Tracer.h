@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 Guido Iodice <guido[dot]iodice[at]gmail[dot]com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+// std
+#include <vector>
+
+namespace Material
+{
+
+/**
+ * Begin/end event recording in the Chrome Trace Event format, to line up
+ * stalls with menu DBus traffic and layout storms.
+ *
+ * Enabled by setting MATERIAL_DECORATION_TRACE in the environment of
+ * KWin, either to 1 or to the path of the output file. Events go to a
+ * ring buffer that is written out when KWin is about to quit, or on
+ * demand through the org.kde.materialdecoration.Trace interface at
+ * /MaterialDecoration/Trace on the KWin session bus connection:
+ *
+ *     qdbus org.kde.KWin /MaterialDecoration/Trace dump
+ *
+ * The result can be loaded into chrome://tracing or ui.perfetto.dev.
+ **/
+class Tracer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.materialdecoration.Trace")
+
+public:
+    // Read once at load time, so that a disabled TraceScope is a single
+    // branch on a plain bool.
+    static inline const bool enabled = qEnvironmentVariableIsSet("MATERIAL_DECORATION_TRACE");
+
+    static Tracer *self();
+    ~Tracer() override;
+
+    /**
+     * @p name must be a string literal, only the pointer is kept.
+     **/
+    void record(const char *name, char phase);
+
+public Q_SLOTS:
+    /**
+     * Write the buffered events as JSON and return the path of the file.
+     **/
+    Q_SCRIPTABLE QString dump();
+
+    Q_SCRIPTABLE void clear();
+
+private:
+    Tracer();
+
+    struct Event {
+        const char *name;
+        qint64 timestamp; // ns
+        quint64 thread;
+        char phase;
+    };
+
+    // About a minute of heavy menu traffic.
+    static constexpr size_t s_capacity = 1 << 16;
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    std::vector<Event> m_events;
+    size_t m_next = 0; // Where the next event goes once the buffer is full
+};
+
+/**
+ * Record a begin event for @p name now and the matching end event when
+ * the scope is left.
+ **/
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name)
+        : m_name(name)
+    {
+        if (Tracer::enabled) {
+            Tracer::self()->record(m_name, 'B');
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (Tracer::enabled) {
+            Tracer::self()->record(m_name, 'E');
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_name;
+};
+
+} // namespace Material
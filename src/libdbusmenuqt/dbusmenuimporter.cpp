@@ -54,6 +54,32 @@ static constexpr auto DBUSMENU_PROPERTY_ICON_DATA_HASH = "_dbusmenu_icon_data_ha
 static constexpr int MAX_ACTIONS_PER_MENU = 1000;
 static constexpr int MAX_TOTAL_ACTIONS = 5000;
 
+static DBusMenuImporter::TraceHook sTraceHook = nullptr;
+
+class TraceHookScope
+{
+public:
+    explicit TraceHookScope(const char *name)
+        : m_hook(sTraceHook)
+        , m_name(name)
+    {
+        if (m_hook) {
+            m_hook(m_name, true);
+        }
+    }
+
+    ~TraceHookScope()
+    {
+        if (m_hook) {
+            m_hook(m_name, false);
+        }
+    }
+
+private:
+    const DBusMenuImporter::TraceHook m_hook;
+    const char *const m_name;
+};
+
 static QAction *createKdeTitle(const QAction *action, QWidget *parent)
 {
     QToolButton *titleWidget = new QToolButton(nullptr);
@@ -331,6 +357,11 @@ QMenu *DBusMenuImporter::menu() const
     return d->m_menu;
 }
 
+void DBusMenuImporter::setTraceHook(TraceHook hook)
+{
+    sTraceHook = hook;
+}
+
 void DBusMenuImporterPrivate::slotItemsPropertiesUpdated(const DBusMenuItemList &updatedList, const DBusMenuItemKeysList &removedList)
 {
     bool needLayoutUpdate = false;
@@ -382,6 +413,7 @@ void DBusMenuImporter::slotItemActivationRequested(int id, uint /*timestamp*/)
 
 void DBusMenuImporter::slotGetLayoutFinished(QDBusPendingCallWatcher *watcher)
 {
+    const TraceHookScope trace("DBusMenuImporter::slotGetLayoutFinished");
     const int parentId = watcher->property(DBUSMENU_PROPERTY_ID).toInt();
     watcher->deleteLater();
 
@@ -41,6 +41,15 @@ public:
      */
     QMenu *menu() const;
 
+    /**
+     * Called with a static name, and true on entry or false on exit, around
+     * the processing of each GetLayout reply, so that the embedding code can
+     * record timings. Shared by all importers; nullptr (the default) turns
+     * it off.
+     */
+    using TraceHook = void (*)(const char *name, bool begin);
+    static void setTraceHook(TraceHook hook);
+
 public Q_SLOTS:
     /**
      * Load the menu